@@ -0,0 +1,339 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file OSC-json-check.c
+ *  @brief Differential check and benchmark of the JSON parser.
+ *
+ *  "OSC-json-check trace file..." parses every file with
+ *  UJSON_parseBuffer(), whole and in parts of 1 to 64 bytes as json.cgi
+ *  receives large requests, and prints the calls of the callbacks. The
+ *  parts must give the same calls as the whole file, else a line
+ *  "MISMATCH" is printed. The SSE2, NEON and byte by byte scanners must
+ *  print the same traces, "make check" compares them with corpus/expected.
+ *
+ *  "OSC-json-check bench [seconds]" prints the throughput of the parser on
+ *  batches of writes as json.cgi receives them, compact (JSON.stringify())
+ *  and pretty-printed.
+ *
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ujsonpars.h"
+
+/** Number of writes of a benchmark batch */
+#define BATCH_WRITES        1000
+
+/** Number of batches parsed in a round of the benchmark */
+#define BENCH_ROUND_PARSES  20
+
+/** @brief Trace of the callbacks */
+typedef struct t_Trace
+{
+    char *pData;        /**< text of the trace */
+    size_t len;         /**< length of the text */
+    size_t size;        /**< size of the allocated text */
+} T_Trace, *PT_Trace;
+
+/**
+ * Append text to a trace.
+ */
+static void traceAppend(PT_Trace pTrace, const char *pText, size_t len)
+{
+    if (pTrace->len + len + 1 > pTrace->size)
+    {
+        pTrace->size = (pTrace->len + len + 1) * 2;
+        pTrace->pData = realloc(pTrace->pData, pTrace->size);
+        if (!pTrace->pData)
+        {
+            perror("realloc");
+            exit(-1);
+        }
+    }
+    memcpy(pTrace->pData + pTrace->len, pText, len);
+    pTrace->len += len;
+    pTrace->pData[pTrace->len] = '\0';
+}
+
+/**
+ * Append a string of the parser to a trace, bytes which are not printable
+ * are written as hexadecimal numbers.
+ */
+static void traceString(PT_Trace pTrace, const char *pStr, int len)
+{
+    char buf[8];
+    int i;
+
+    sprintf(buf, "%d:", len);
+    traceAppend(pTrace, buf, strlen(buf));
+    for (i = 0; i < len; i++)
+    {
+        unsigned char c = (unsigned char)pStr[i];
+        if (c >= ' ' && c < 0x7F && c != '\\')
+            traceAppend(pTrace, pStr + i, 1);
+        else
+        {
+            sprintf(buf, "\\x%02X", c);
+            traceAppend(pTrace, buf, 4);
+        }
+    }
+}
+
+static void startObject(void *ptr)
+{
+    traceAppend((PT_Trace)((PT_uJson)ptr)->pObject, "{\n", 2);
+}
+
+static void endObject(void *ptr)
+{
+    traceAppend((PT_Trace)((PT_uJson)ptr)->pObject, "}\n", 2);
+}
+
+static void startArray(void *ptr)
+{
+    traceAppend((PT_Trace)((PT_uJson)ptr)->pObject, "[\n", 2);
+}
+
+static void endArray(void *ptr)
+{
+    traceAppend((PT_Trace)((PT_uJson)ptr)->pObject, "]\n", 2);
+}
+
+static void startPair(void *ptr, char *pPair)
+{
+    PT_uJson pJson = (PT_uJson)ptr;
+    PT_Trace pTrace = (PT_Trace)pJson->pObject;
+
+    traceAppend(pTrace, "pair ", 5);
+    traceString(pTrace, pPair, pJson->pairLen);
+    traceAppend(pTrace, "\n", 1);
+}
+
+static void value(void *ptr, char *pPair, char *pValue)
+{
+    PT_uJson pJson = (PT_uJson)ptr;
+    PT_Trace pTrace = (PT_Trace)pJson->pObject;
+
+    traceAppend(pTrace, "value ", 6);
+    if (pPair)
+        traceString(pTrace, pPair, pJson->pairLen);
+    else
+        traceAppend(pTrace, "-", 1);
+    traceAppend(pTrace, " ", 1);
+    traceString(pTrace, pValue, pJson->valueLen);
+    traceAppend(pTrace, "\n", 1);
+}
+
+/**
+ * Value callback of the benchmark.
+ */
+static void ignore(void *ptr, char *pPair, char *pValue)
+{
+}
+
+/**
+ * Parse data in parts and trace the callbacks. The data not consumed stays
+ * in the buffer and the next part is appended, as json.cgi does.
+ * @param pData Data
+ * @param len Length of the data
+ * @param part Length of the parts, len for the whole data at once
+ * @param pTrace Trace
+ */
+static void parseParts(const char *pData, long len, long part, PT_Trace pTrace)
+{
+    char *pBuf = malloc(len + 1);
+    long start = 0, avail = 0, n;
+    T_uJson json;
+    char end[48];
+
+    UJSON_init(&json);
+    json.pObject = pTrace;
+    json.startObject = startObject;
+    json.endObject = endObject;
+    json.startArray = startArray;
+    json.endArray = endArray;
+    json.startPair = startPair;
+    json.value = value;
+
+    memcpy(pBuf, pData, len);
+    pTrace->len = 0;
+    n = 0;
+    while (!json.eof)
+    {
+        avail = avail + part < len ? avail + part : len;
+        n = UJSON_parseBuffer(&json, pBuf + start, avail - start, avail == len);
+        if (n < 0)
+            break;
+        start += n;
+        if (avail == len)
+            break;
+    }
+
+    if (n < 0)
+        sprintf(end, "error\n");
+    else
+        sprintf(end, "consumed %ld of %ld\n", start, len);
+    traceAppend(pTrace, end, strlen(end));
+    free(pBuf);
+}
+
+/**
+ * Print the traces of files.
+ */
+static int trace(int argc, char *argv[])
+{
+    T_Trace whole = { NULL, 0, 0 };
+    T_Trace parts = { NULL, 0, 0 };
+    int mismatches = 0;
+    int i;
+
+    for (i = 0; i < argc; i++)
+    {
+        FILE *f = fopen(argv[i], "rb");
+        const char *pName = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+        char *pData;
+        long len, part;
+
+        if (!f)
+        {
+            perror(argv[i]);
+            return -1;
+        }
+        fseek(f, 0, SEEK_END);
+        len = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        pData = malloc(len + 1);
+        if (fread(pData, 1, len, f) != (size_t)len)
+            len = 0;
+        fclose(f);
+
+        printf("== %s\n", pName);
+        parseParts(pData, len, len > 0 ? len : 1, &whole);
+        for (part = 1; part <= 64 && part < len; part++)
+        {
+            parseParts(pData, len, part, &parts);
+            if (parts.len != whole.len || memcmp(parts.pData, whole.pData, whole.len) != 0)
+            {
+                printf("MISMATCH in parts of %ld bytes\n", part);
+                mismatches++;
+            }
+        }
+        fwrite(whole.pData, 1, whole.len, stdout);
+        free(pData);
+    }
+
+    free(whole.pData);
+    free(parts.pData);
+    return mismatches ? -1 : 0;
+}
+
+/**
+ * Build a batch of writes as json.cgi receives them.
+ * @param pBuf Buffer
+ * @param pretty Set for a pretty-printed batch
+ * @return Length of the batch
+ */
+static long buildBatch(char *pBuf, int pretty)
+{
+    long len;
+    int i;
+
+    len = sprintf(pBuf, pretty ? "{\n    \"version\": \"1\",\n    \"write\": [\n" : "{\"version\":\"1\",\"write\":[");
+    for (i = 0; i < BATCH_WRITES; i++)
+    {
+        if (pretty)
+            len += sprintf(pBuf + len, "%s        {\n            \"var\": \"/mixer/ch%d/fader\",\n            \"val\": \"0.%03d\"\n        }",
+                           i ? ",\n" : "", i, i % 1000);
+        else
+            len += sprintf(pBuf + len, "%s{\"var\":\"/mixer/ch%d/fader\",\"val\":\"0.%03d\"}", i ? "," : "", i, i % 1000);
+    }
+    len += sprintf(pBuf + len, pretty ? "\n    ]\n}\n" : "]}");
+    return len;
+}
+
+/**
+ * Get the time in seconds.
+ */
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * Print the throughput of the parser. The batches are parsed in rounds of
+ * BENCH_ROUND_PARSES, the fastest round is taken so that other processes
+ * disturb the result less.
+ */
+static int bench(double seconds)
+{
+    static const char *pNames[] = { "compact", "pretty-printed" };
+    char *pBatch = malloc(BATCH_WRITES * 128 + 64);
+    char *pBuf = malloc(BATCH_WRITES * 128 + 64);
+    T_uJson json;
+    int pretty;
+
+    for (pretty = 0; pretty < 2; pretty++)
+    {
+        long len = buildBatch(pBatch, pretty);
+        double start = now(), best = 1e9, round;
+        int i;
+
+        do
+        {
+            round = now();
+            for (i = 0; i < BENCH_ROUND_PARSES; i++)
+            {
+                // the parser modifies the buffer
+                memcpy(pBuf, pBatch, len);
+                UJSON_init(&json);
+                json.value = ignore;
+                UJSON_parseBuffer(&json, pBuf, len, 1);
+            }
+            round = now() - round;
+            if (round < best)
+                best = round;
+        }
+        while (now() - start < seconds);
+
+        printf("%-15s %7ld bytes %8.0f MB/s\n", pNames[pretty], len, BENCH_ROUND_PARSES * (double)len / best / 1e6);
+    }
+
+    free(pBatch);
+    free(pBuf);
+    return 0;
+}
+
+/**
+ */
+int main(int argc, char *argv[])
+{
+    if (argc >= 2 && strcmp(argv[1], "trace") == 0)
+        return trace(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0)
+        return bench(argc >= 3 ? atof(argv[2]) : 2.0);
+
+    printf("usage: OSC-json-check trace file...\n"
+           "       OSC-json-check bench [seconds]\n");
+    return -1;
+}
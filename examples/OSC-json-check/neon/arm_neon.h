@@ -0,0 +1,138 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file arm_neon.h
+ *  @brief Portable C stand-in for the NEON intrinsics used by ujsonpars.c.
+ *
+ *  Compiling ujsonpars.c with "-Ineon -D__ARM_NEON -U__SSE2__" runs its NEON
+ *  scanner on any host, so that "make check" compares it with the corpus
+ *  when no ARM compiler is available. Only the semantics are emulated, not
+ *  the speed; lanes are stored little-endian as on the Raspberry Pi.
+ *
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef ARM_NEON_EMU_H
+#define ARM_NEON_EMU_H
+
+#include <stdint.h>
+#include <string.h>
+
+/** @brief 16 lanes of 8 bits */
+typedef struct { uint8_t v[16]; } uint8x16_t;
+/** @brief 8 lanes of 16 bits */
+typedef struct { uint8_t v[16]; } uint16x8_t;
+/** @brief 8 lanes of 8 bits */
+typedef struct { uint8_t v[8]; } uint8x8_t;
+/** @brief 1 lane of 64 bits */
+typedef struct { uint8_t v[8]; } uint64x1_t;
+
+static inline uint8x16_t vld1q_u8(const uint8_t *p)
+{
+    uint8x16_t r;
+    memcpy(r.v, p, 16);
+    return r;
+}
+
+static inline uint8x16_t vdupq_n_u8(uint8_t x)
+{
+    uint8x16_t r;
+    memset(r.v, x, 16);
+    return r;
+}
+
+static inline uint8x16_t vceqq_u8(uint8x16_t a, uint8x16_t b)
+{
+    int i;
+    for (i = 0; i < 16; i++)
+        a.v[i] = a.v[i] == b.v[i] ? 0xFF : 0;
+    return a;
+}
+
+static inline uint8x16_t vcleq_u8(uint8x16_t a, uint8x16_t b)
+{
+    int i;
+    for (i = 0; i < 16; i++)
+        a.v[i] = a.v[i] <= b.v[i] ? 0xFF : 0;
+    return a;
+}
+
+static inline uint8x16_t vorrq_u8(uint8x16_t a, uint8x16_t b)
+{
+    int i;
+    for (i = 0; i < 16; i++)
+        a.v[i] |= b.v[i];
+    return a;
+}
+
+static inline uint8x16_t vsubq_u8(uint8x16_t a, uint8x16_t b)
+{
+    int i;
+    for (i = 0; i < 16; i++)
+        a.v[i] = (uint8_t)(a.v[i] - b.v[i]);
+    return a;
+}
+
+static inline uint8x16_t vmvnq_u8(uint8x16_t a)
+{
+    int i;
+    for (i = 0; i < 16; i++)
+        a.v[i] = (uint8_t)~a.v[i];
+    return a;
+}
+
+static inline uint16x8_t vreinterpretq_u16_u8(uint8x16_t a)
+{
+    uint16x8_t r;
+    memcpy(r.v, a.v, 16);
+    return r;
+}
+
+/** Shift each 16-bit lane right by n and keep its low 8 bits */
+#define vshrn_n_u16(a, n)   neonShrn((a), (n))
+
+static inline uint8x8_t neonShrn(uint16x8_t a, int n)
+{
+    uint8x8_t r;
+    int i;
+    for (i = 0; i < 8; i++)
+        r.v[i] = (uint8_t)((a.v[2 * i] | (a.v[2 * i + 1] << 8)) >> n);
+    return r;
+}
+
+static inline uint64x1_t vreinterpret_u64_u8(uint8x8_t a)
+{
+    uint64x1_t r;
+    memcpy(r.v, a.v, 8);
+    return r;
+}
+
+/** Get the 64-bit lane (0) as a little-endian value */
+#define vget_lane_u64(a, lane)  neonGetLane64(a)
+
+static inline uint64_t neonGetLane64(uint64x1_t a)
+{
+    uint64_t r = 0;
+    int i;
+    for (i = 7; i >= 0; i--)
+        r = (r << 8) | a.v[i];
+    return r;
+}
+
+#endif // ARM_NEON_EMU_H
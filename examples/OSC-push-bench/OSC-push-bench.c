@@ -0,0 +1,363 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file OSC-push-bench.c
+ *  @brief Benchmark of push.cgi with many subscribers.
+ *
+ *  Opens 500 push.cgi streams (-n) and one stalled subscriber, which never
+ *  reads and has a small receive buffer. It then sends 1000 json.cgi
+ *  writes (-w) of one variable (-k) back to back, and reads the streams
+ *  until every subscriber has received every change.
+ *
+ *  Prints the number of changes delivered per subscriber, the time to
+ *  post and to drain, the subscribers closed by the server and whether the
+ *  stalled subscriber was closed. With the process id of OSC-webgate (-p),
+ *  the CPU time of the server per write and its resident memory are
+ *  printed too (Linux).
+ *
+ *  A delay after every write (-d) leaves time to the subscribers to read,
+ *  without it the kernel buffers fill and slow subscribers are disconnected.
+ *
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/** Pattern counted in the streams, once per change */
+#define PATTERN             "\"var\""
+
+/** Length of the padding of the values written */
+#define VALUE_PADDING       240
+
+/** Receive buffer of the stalled subscriber */
+#define STALLED_RCVBUF      4096
+
+/** Maximal time to drain the streams in seconds */
+#define DRAIN_TIMEOUT       20.0
+
+/** @brief Push.cgi stream */
+typedef struct t_Subscriber
+{
+    int fd;                 /**< socket, -1 once closed by the server */
+    long changes;           /**< changes received */
+    int match;              /**< length of PATTERN matched so far */
+} T_Subscriber, *PT_Subscriber;
+
+static const char *pHost;
+static const char *pPort;
+
+/**
+ * Get the time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Connect to OSC-webgate and send a request, return the socket or -1.
+ */
+static int sendRequest(const char *pRequest, int len, int rcvbuf)
+{
+    struct addrinfo hints, *pAddr;
+    int fd;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(pHost, pPort, &hints, &pAddr))
+        return -1;
+
+    fd = socket(pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol);
+    if (fd >= 0 && rcvbuf)
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (fd >= 0 && (connect(fd, pAddr->ai_addr, pAddr->ai_addrlen) || send(fd, pRequest, len, 0) != len))
+    {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(pAddr);
+    return fd;
+}
+
+/**
+ * Open a push.cgi stream, return the socket or -1.
+ */
+static int subscribe(int rcvbuf)
+{
+    char request[256];
+    int len = snprintf(request, sizeof(request), "GET /cgi-bin/push.cgi HTTP/1.1\r\nHost: %s\r\n\r\n", pHost);
+
+    return sendRequest(request, len, rcvbuf);
+}
+
+/**
+ * Send a json.cgi write and wait for the response, return 0 on success.
+ */
+static int postWrite(int index, int variables)
+{
+    static char body[65536];
+    char request[65536 + 256];
+    int len, fd, i;
+
+    len = sprintf(body, "{\"version\":\"1\",\"write\":[");
+    for (i = 0; i < variables && len < (int)sizeof(body) - VALUE_PADDING - 64; i++)
+        len += sprintf(body + len, "%s{\"var\":\"/push/x%d\",\"val\":\"%d%0*d\"}", i ? "," : "", i, index, VALUE_PADDING, 0);
+    len += sprintf(body + len, "]}");
+
+    len = sprintf(request, "POST /cgi-bin/json.cgi HTTP/1.1\r\nHost: %s\r\nContent-Length: %d\r\nConnection: close\r\n\r\n%s",
+                  pHost, len, body);
+    fd = sendRequest(request, len, 0);
+    if (fd < 0)
+        return -1;
+
+    // read the response until the server closes the connection
+    while (recv(fd, request, sizeof(request), 0) > 0)
+        ;
+    close(fd);
+    return 0;
+}
+
+/**
+ * Read the streams for a time in seconds, count the changes received.
+ */
+static void pump(PT_Subscriber pSubs, struct pollfd *pFds, int count, double seconds)
+{
+    double end = now() + seconds;
+    static char buffer[65536];
+    int i;
+
+    do
+    {
+        for (i = 0; i < count; i++)
+        {
+            pFds[i].fd = pSubs[i].fd;
+            pFds[i].events = POLLIN;
+            pFds[i].revents = 0;
+        }
+        if (poll(pFds, count, seconds > 0 ? 50 : 0) <= 0)
+            continue;
+
+        for (i = 0; i < count; i++)
+        {
+            PT_Subscriber pSub = &pSubs[i];
+            int n, j;
+
+            if (!(pFds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            n = (int)recv(pSub->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                continue;
+            if (n <= 0)
+            {
+                close(pSub->fd);
+                pSub->fd = -1;
+                continue;
+            }
+
+            // the pattern may be split between two reads
+            for (j = 0; j < n; j++)
+            {
+                if (buffer[j] == PATTERN[pSub->match])
+                    pSub->match++;
+                else
+                    pSub->match = buffer[j] == PATTERN[0] ? 1 : 0;
+                if (pSub->match == (int)strlen(PATTERN))
+                {
+                    pSub->changes++;
+                    pSub->match = 0;
+                }
+            }
+        }
+    }
+    while (now() < end);
+}
+
+/**
+ * Get the CPU time of a process in seconds and its resident memory in kB.
+ */
+static int readProcess(int pid, double *pCpu, long *pRss)
+{
+    char path[64], line[1024];
+    unsigned long utime, stime;
+    FILE *f;
+
+    sprintf(path, "/proc/%d/stat", pid);
+    f = fopen(path, "r");
+    if (!f)
+        return -1;
+    if (!fgets(line, sizeof(line), f) || !strrchr(line, ')') ||
+        sscanf(strrchr(line, ')') + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2)
+    {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    *pCpu = (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+
+    sprintf(path, "/proc/%d/status", pid);
+    f = fopen(path, "r");
+    if (!f)
+        return -1;
+    *pRss = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (sscanf(line, "VmRSS: %ld", pRss) == 1)
+            break;
+    }
+    fclose(f);
+    return 0;
+}
+
+/**
+ */
+int main(int argc, char *argv[])
+{
+    int subscribers = 500, writes = 1000, variables = 1, pid = 0;
+    double delay = 0, cpu0 = 0, cpu1 = 0, t0, t1, t2;
+    long rss = 0, minChanges, maxChanges, stalledBytes = 0;
+    PT_Subscriber pSubs;
+    struct pollfd *pFds;
+    int stalled, closed = 0, opt, i;
+
+    while ((opt = getopt(argc, argv, "n:w:k:p:d:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': subscribers = atoi(optarg); break;
+            case 'w': writes = atoi(optarg); break;
+            case 'k': variables = atoi(optarg); break;
+            case 'p': pid = atoi(optarg); break;
+            case 'd': delay = atof(optarg) / 1000; break;
+            default: optind = argc + 1; break;
+        }
+    }
+    if (optind != argc - 2 || subscribers <= 0 || writes <= 0 || variables <= 0)
+    {
+        printf("usage: OSC-push-bench [-n subscribers] [-w writes] [-k variables per write]\n"
+               "                      [-p pid of OSC-webgate] [-d delay ms after a write] host port\n");
+        return -1;
+    }
+    pHost = argv[optind];
+    pPort = argv[optind + 1];
+
+    pSubs = calloc(subscribers, sizeof(T_Subscriber));
+    pFds = calloc(subscribers, sizeof(struct pollfd));
+    for (i = 0; i < subscribers; i++)
+    {
+        pSubs[i].fd = subscribe(0);
+        if (pSubs[i].fd < 0)
+        {
+            printf("cannot open subscriber %d (open files: ulimit -n)\n", i);
+            return -1;
+        }
+    }
+    stalled = subscribe(STALLED_RCVBUF);
+
+    // skip the headers and the initial values
+    usleep(500000);
+    pump(pSubs, pFds, subscribers, 0.3);
+    for (i = 0; i < subscribers; i++)
+        pSubs[i].changes = 0;
+
+    if (pid && readProcess(pid, &cpu0, &rss))
+        pid = 0;
+    t0 = now();
+    for (i = 0; i < writes; i++)
+    {
+        if (postWrite(i, variables))
+        {
+            printf("json.cgi write %d failed\n", i);
+            return -1;
+        }
+        if (delay > 0)
+            pump(pSubs, pFds, subscribers, delay);
+    }
+
+    // drain until every open subscriber has received every change
+    t1 = now();
+    do
+    {
+        pump(pSubs, pFds, subscribers, 0.05);
+        minChanges = -1;
+        for (i = 0; i < subscribers; i++)
+        {
+            if (pSubs[i].fd >= 0 && (minChanges < 0 || pSubs[i].changes < minChanges))
+                minChanges = pSubs[i].changes;
+        }
+    }
+    while (minChanges >= 0 && minChanges < (long)writes * variables && now() - t1 < DRAIN_TIMEOUT);
+    t2 = now();
+    if (pid && readProcess(pid, &cpu1, &rss))
+        pid = 0;
+
+    minChanges = -1;
+    maxChanges = 0;
+    for (i = 0; i < subscribers; i++)
+    {
+        if (pSubs[i].fd < 0)
+            closed++;
+        if (minChanges < 0 || pSubs[i].changes < minChanges)
+            minChanges = pSubs[i].changes;
+        if (pSubs[i].changes > maxChanges)
+            maxChanges = pSubs[i].changes;
+    }
+
+    printf("subscribers %d, writes %d of %d variables\n", subscribers, writes, variables);
+    printf("changes delivered min/max %ld/%ld of %ld\n", minChanges, maxChanges, (long)writes * variables);
+    printf("post %.2f s, drain %.2f s\n", t1 - t0, t2 - t1);
+    if (pid)
+        printf("server CPU %.2f s (%.0f us per write), RSS %ld kB\n", cpu1 - cpu0, (cpu1 - cpu0) / writes * 1e6, rss);
+    printf("subscribers closed by the server %d\n", closed);
+
+    // read what the stalled subscriber has received
+    if (stalled >= 0)
+    {
+        char buffer[65536];
+        int n;
+
+        while ((n = (int)recv(stalled, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+            stalledBytes += n;
+        if (n == 0)
+            printf("stalled subscriber closed by the server after %ld bytes\n", stalledBytes);
+        else
+            printf("stalled subscriber still open, %ld bytes read\n", stalledBytes);
+        close(stalled);
+    }
+
+    for (i = 0; i < subscribers; i++)
+    {
+        if (pSubs[i].fd >= 0)
+            close(pSubs[i].fd);
+    }
+    free(pSubs);
+    free(pFds);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file OSC-tcp-sink.c
+ *  @brief OSC host for tests of OSC over TCP.
+ *
+ *  Listens on a TCP port, decodes the SLIP frames (OSC 1.1) sent by
+ *  OSC-webgate and prints the address and the arguments of every message.
+ *  A delay per frame simulates a slow OSC host.
+ *
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define SLIP_END        0xC0
+#define SLIP_ESC        0xDB
+#define SLIP_ESC_END    0xDC
+#define SLIP_ESC_ESC    0xDD
+
+#define FRAME_SIZE      65536
+
+static unsigned int readInt32(const unsigned char *p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+/**
+ * Print a message or the messages of a bundle.
+ */
+static void printPacket(const unsigned char *p, int len)
+{
+    const unsigned char *pEnd = p + len;
+    const char *pTags;
+    int n;
+
+    if (len >= 16 && memcmp(p, "#bundle", 8) == 0)
+    {
+        printf("bundle %08x%08x\n", readInt32(p + 8), readInt32(p + 12));
+        for (p += 16; pEnd - p >= 4; p += 4 + readInt32(p))
+        {
+            if (readInt32(p) > (unsigned int)(pEnd - p - 4))
+                break;
+            printPacket(p + 4, (int)readInt32(p));
+        }
+        return;
+    }
+
+    // address and type tags, padded to 4 bytes
+    n = (int)strnlen((const char*)p, len);
+    printf("%.*s", n, (const char*)p);
+    p += (n + 4) & ~3;
+    if (p >= pEnd || *p != ',')
+    {
+        // arguments without type tags, print them as 32 bit words
+        for (; pEnd - p >= 4; p += 4)
+            printf(" %08x", readInt32(p));
+        printf("\n");
+        return;
+    }
+    pTags = (const char*)p + 1;
+    n = (int)strnlen((const char*)p, pEnd - p);
+    p += (n + 4) & ~3;
+    for (; *pTags && p <= pEnd; pTags++)
+    {
+        union { unsigned int i; float f; } u;
+        switch (*pTags)
+        {
+        case 'i':
+            if (pEnd - p < 4)
+                break;
+            printf(" %d", (int)readInt32(p));
+            p += 4;
+            break;
+        case 'f':
+            if (pEnd - p < 4)
+                break;
+            u.i = readInt32(p);
+            printf(" %g", u.f);
+            p += 4;
+            break;
+        case 's':
+            n = (int)strnlen((const char*)p, pEnd - p);
+            printf(" \"%.*s\"", n, (const char*)p);
+            p += (n + 4) & ~3;
+            break;
+        default:
+            printf(" %c", *pTags);
+            break;
+        }
+    }
+    printf("\n");
+}
+
+/**
+ */
+int main(int argc, char *argv[])
+{
+    static unsigned char frame[FRAME_SIZE];
+    struct sockaddr_in addr;
+    int delayMs = 0;
+    int s, c, on = 1;
+
+    // check arguments
+    if (argc < 2 || argc > 3)
+    {
+        printf("usage: OSC-tcp-sink port [delay ms per frame]\n");
+        return -1;
+    }
+    if (argc == 3)
+        delayMs = atoi(argv[2]);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(atoi(argv[1]));
+    s = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) || listen(s, 1))
+    {
+        perror("bind");
+        return -1;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    // one connection at a time
+    while ((c = accept(s, NULL, NULL)) >= 0)
+    {
+        unsigned char buffer[4096];
+        int len = 0, escaped = 0, n, i;
+
+        printf("connected\n");
+        while ((n = (int)recv(c, buffer, sizeof(buffer), 0)) > 0)
+        {
+            for (i = 0; i < n; i++)
+            {
+                unsigned char ch = buffer[i];
+                if (ch == SLIP_END)
+                {
+                    // empty frames are the delimiters of double-ended SLIP
+                    if (len > 0)
+                    {
+                        printPacket(frame, len);
+                        if (delayMs)
+                            usleep(delayMs * 1000);
+                    }
+                    len = 0;
+                    escaped = 0;
+                    continue;
+                }
+                if (escaped)
+                {
+                    ch = ch == SLIP_ESC_END ? SLIP_END : ch == SLIP_ESC_ESC ? SLIP_ESC : ch;
+                    escaped = 0;
+                }
+                else if (ch == SLIP_ESC)
+                {
+                    escaped = 1;
+                    continue;
+                }
+                if (len < FRAME_SIZE)
+                    frame[len++] = ch;
+            }
+        }
+        printf("disconnected\n");
+        close(c);
+    }
+    return 0;
+}
@@ -23,12 +23,18 @@
 /** Input and output buffer size */
 #define HTTP_CLIENT_BUFFER_SIZE         2048
 
+/** Content type of msgpack.cgi requests */
+#define MSGPACK_CONTENT_TYPE            "application/x-msgpack"
+
 /** Output buffer */
 static char pBufferOut[HTTP_CLIENT_BUFFER_SIZE];
 
 /** Input buffer */
 static char pBufferIn[HTTP_CLIENT_BUFFER_SIZE];
 
+/** Buffer of msgpack.cgi requests */
+static char pBufferMsgPack[HTTP_CLIENT_BUFFER_SIZE];
+
 /**
  * @brief Sends a GET request to the server and stores the response in pReceived.
  * @param uri URI with GET request
@@ -179,6 +185,248 @@ static void str_encode(char* pStr)
     str_replaceChar(pStr, ' ', '+');
 }
 
+/**
+ * @brief Sends a POST request to the server and stores the response in pReceived.
+ * @param uri URI of the request
+ * @param pContentType Content type of the request
+ * @param pData Body of the request
+ * @param len Length of the body
+ * @param pReceived Buffer where response is stored
+ * @param receiveMax Buffer size of pReceived
+ * @return Length of the response, -1 on error
+ */
+static int requestPOST(char *uri, const char *pContentType, const char *pData, unsigned int len, char *pReceived, unsigned int receiveMax)
+{
+    INT32                   nRetCode;
+    UINT32                  nSize, nRead = 0;
+    HTTP_SESSION_HANDLE     pHTTP;
+
+    // Open the HTTP request handle
+    pHTTP = HTTPClientOpenRequest(0);
+    if (!pHTTP)
+        return -1;
+
+    // Set the Verb and the content type
+    if (HTTPClientSetVerb(pHTTP, VerbPost) != HTTP_CLIENT_SUCCESS ||
+        HTTPClientAddRequestHeaders(pHTTP, "Content-Type", (CHAR*)pContentType, FALSE) != HTTP_CLIENT_SUCCESS)
+    {
+        goto Exception;
+    }
+
+    // Send the request with its body
+    if (HTTPClientSendRequest(pHTTP, uri, (VOID*)pData, len, TRUE, 0, 0) != HTTP_CLIENT_SUCCESS)
+    {
+        goto Exception;
+    }
+
+    // Retrieve the headers and analyse them
+    if ((nRetCode = HTTPClientRecvResponse(pHTTP, 3)) != HTTP_CLIENT_SUCCESS)
+    {
+        goto Exception;
+    }
+
+    // Get the data until we get an error, the end of stream or a full buffer
+    while (nRetCode == HTTP_CLIENT_SUCCESS && nRead < receiveMax)
+    {
+        nSize = receiveMax - nRead;
+        nRetCode = HTTPClientReadData(pHTTP, pReceived + nRead, nSize, 0, &nSize);
+        nRead += nSize;
+    }
+
+    HTTPClientCloseRequest(&pHTTP);
+    return nRetCode == HTTP_CLIENT_EOS ? (int)nRead : -1;
+
+Exception:
+    HTTPClientCloseRequest(&pHTTP);
+    return -1;
+}
+
+/**
+ * @brief Appends the header of a MessagePack string, array or map.
+ * @param pBuf Buffer
+ * @param size Size of the buffer
+ * @param pos Position in the buffer, -1 after an error
+ * @param fix Format of the fix size ('\xa0' string, '\x90' array, '\x80' map)
+ * @param count Length of the string or number of elements
+ * @return New position, -1 if the buffer is too small
+ */
+static int packHeader(char *pBuf, unsigned int size, int pos, unsigned char fix, unsigned int count)
+{
+    unsigned char hdr[5];
+    int n;
+
+    if (pos < 0)
+        return -1;
+
+    if (count < (fix == 0xa0 ? 32u : 16u))
+    {
+        hdr[0] = fix | count;
+        n = 1;
+    }
+    else if (fix == 0xa0 && count < 256)
+    {
+        hdr[0] = 0xd9;
+        hdr[1] = count;
+        n = 2;
+    }
+    else if (count < 65536)
+    {
+        hdr[0] = fix == 0xa0 ? 0xda : fix == 0x90 ? 0xdc : 0xde;
+        hdr[1] = count >> 8;
+        hdr[2] = count;
+        n = 3;
+    }
+    else
+    {
+        hdr[0] = fix == 0xa0 ? 0xdb : fix == 0x90 ? 0xdd : 0xdf;
+        hdr[1] = count >> 24;
+        hdr[2] = count >> 16;
+        hdr[3] = count >> 8;
+        hdr[4] = count;
+        n = 5;
+    }
+
+    if (pos + n > (int)size)
+        return -1;
+    memcpy(pBuf + pos, hdr, n);
+    return pos + n;
+}
+
+/**
+ * @brief Appends a MessagePack string.
+ * @param pBuf Buffer
+ * @param size Size of the buffer
+ * @param pos Position in the buffer, -1 after an error
+ * @param pStr String
+ * @return New position, -1 if the buffer is too small
+ */
+static int packStr(char *pBuf, unsigned int size, int pos, const char *pStr)
+{
+    unsigned int len = strlen(pStr);
+
+    pos = packHeader(pBuf, size, pos, 0xa0, len);
+    if (pos < 0 || pos + len > size)
+        return -1;
+    memcpy(pBuf + pos, pStr, len);
+    return pos + len;
+}
+
+/**
+ * @brief Decodes the header of the next MessagePack object.
+ * @param ppData Data, moved after the header
+ * @param pEnd End of the data
+ * @param pType Format of the object: 's' string or binary, 'a' array,
+ *              'm' map, 'x' any other object, which has no elements
+ * @param pLen Length of the string or binary, number of elements of the
+ *             array or map, length of the remaining data of other objects
+ * @return 0 on success, -1 if the data is truncated
+ */
+static int unpackHeader(const unsigned char **ppData, const unsigned char *pEnd, char *pType, unsigned int *pLen)
+{
+    const unsigned char *p = *ppData;
+    unsigned char c;
+    int n = 0;
+
+    if (p >= pEnd)
+        return -1;
+    c = *p++;
+    *pLen = 0;
+
+    if (c <= 0x8f && c >= 0x80)
+    {
+        // fixmap
+        *pType = 'm';
+        *pLen = c & 0x0f;
+    }
+    else if (c <= 0x9f && c >= 0x90)
+    {
+        // fixarray
+        *pType = 'a';
+        *pLen = c & 0x0f;
+    }
+    else if (c <= 0xbf && c >= 0xa0)
+    {
+        // fixstr
+        *pType = 's';
+        *pLen = c & 0x1f;
+    }
+    else if (c >= 0xc4 && c <= 0xc6)
+    {
+        // bin 8, 16, 32
+        *pType = 's';
+        n = 1 << (c - 0xc4);
+    }
+    else if (c >= 0xd9 && c <= 0xdb)
+    {
+        // str 8, 16, 32
+        *pType = 's';
+        n = 1 << (c - 0xd9);
+    }
+    else if (c == 0xdc || c == 0xdd)
+    {
+        // array 16, 32
+        *pType = 'a';
+        n = c == 0xdc ? 2 : 4;
+    }
+    else if (c == 0xde || c == 0xdf)
+    {
+        // map 16, 32
+        *pType = 'm';
+        n = c == 0xde ? 2 : 4;
+    }
+    else
+    {
+        // fixint, nil, bool, uint and int 8 to 64, float 32 and 64
+        *pType = 'x';
+        if (c >= 0xcc && c <= 0xd3)
+            *pLen = 1 << ((c - 0xcc) & 3);
+        else if (c == 0xca || c == 0xcb)
+            *pLen = c == 0xca ? 4 : 8;
+        else if (!(c <= 0x7f || c >= 0xe0 || (c >= 0xc0 && c <= 0xc3)))
+            return -1;  // extensions are not used
+    }
+
+    if (p + n > pEnd)
+        return -1;
+    while (n--)
+        *pLen = (*pLen << 8) | *p++;
+    *ppData = p;
+    return 0;
+}
+
+/**
+ * @brief Skips the next MessagePack object including its elements.
+ * @param ppData Data, moved after the object
+ * @param pEnd End of the data
+ * @param depth Maximal nesting depth
+ * @return 0 on success, -1 if the data is truncated or nested too deep
+ */
+static int unpackSkip(const unsigned char **ppData, const unsigned char *pEnd, int depth)
+{
+    unsigned int len, i;
+    char type;
+
+    if (depth == 0 || unpackHeader(ppData, pEnd, &type, &len))
+        return -1;
+
+    if (type == 'a' || type == 'm')
+    {
+        if (type == 'm')
+            len *= 2;
+        for (i = 0; i < len; i++)
+        {
+            if (unpackSkip(ppData, pEnd, depth - 1))
+                return -1;
+        }
+        return 0;
+    }
+
+    if ((unsigned int)(pEnd - *ppData) < len)
+        return -1;
+    *ppData += len;
+    return 0;
+}
+
 /**
  */
 void OSCC_init(void)
@@ -247,3 +495,127 @@ int OSCC_setValue(const char *pHostAddress, const char *pVariable, const char *p
 
     return requestGET(pBufferOut, pBufferIn, HTTP_CLIENT_BUFFER_SIZE);
 }
+
+/**
+ */
+int OSCC_post(const char *pHostAddress, const char *pPath, const char *pContentType,
+              const char *pData, unsigned int len, char *pReceived, unsigned int receiveMax)
+{
+    strcpy(pBufferOut, "http://");
+    strcat(pBufferOut, pHostAddress);
+    strcat(pBufferOut, pPath);
+
+    return requestPOST(pBufferOut, pContentType, pData, len, pReceived, receiveMax);
+}
+
+/**
+ */
+int OSCC_packRead(char *pBuf, unsigned int size, const char **ppVariables, unsigned int count)
+{
+    int pos;
+    unsigned int i;
+
+    pos = packHeader(pBuf, size, 0, 0x80, 1);
+    pos = packStr(pBuf, size, pos, "read");
+    pos = packHeader(pBuf, size, pos, 0x90, count);
+    for (i = 0; i < count; i++)
+        pos = packStr(pBuf, size, pos, ppVariables[i]);
+    return pos;
+}
+
+/**
+ */
+int OSCC_packWrite(char *pBuf, unsigned int size, const char **ppVariables, const char **ppValues, unsigned int count)
+{
+    int pos;
+    unsigned int i;
+
+    pos = packHeader(pBuf, size, 0, 0x80, 1);
+    pos = packStr(pBuf, size, pos, "write");
+    pos = packHeader(pBuf, size, pos, 0x80, count);
+    for (i = 0; i < count; i++)
+    {
+        pos = packStr(pBuf, size, pos, ppVariables[i]);
+        pos = packStr(pBuf, size, pos, ppValues[i]);
+    }
+    return pos;
+}
+
+/**
+ */
+int OSCC_unpackValues(const char *pData, unsigned int len, const char *pMember,
+                      char **ppValues, unsigned int count, unsigned int valueMaxSize)
+{
+    const unsigned char *p = (const unsigned char*)pData;
+    const unsigned char *pEnd = p + len;
+    unsigned int members, n, i;
+    char type;
+
+    if (unpackHeader(&p, pEnd, &type, &members) || type != 'm')
+        return -1;
+
+    while (members--)
+    {
+        // member name
+        if (unpackHeader(&p, pEnd, &type, &n) || type != 's' || (unsigned int)(pEnd - p) < n)
+            return -1;
+        if (n != strlen(pMember) || memcmp(p, pMember, n) != 0)
+        {
+            p += n;
+            if (unpackSkip(&p, pEnd, 8))
+                return -1;
+            continue;
+        }
+        p += n;
+
+        // array of values
+        if (unpackHeader(&p, pEnd, &type, &n) || type != 'a')
+            return -1;
+        for (i = 0; i < n; i++)
+        {
+            unsigned int valueLen;
+
+            if (unpackHeader(&p, pEnd, &type, &valueLen) || type != 's' || (unsigned int)(pEnd - p) < valueLen)
+                return -1;
+            if (i < count && valueMaxSize > 0)
+            {
+                unsigned int copyLen = valueLen < valueMaxSize ? valueLen : valueMaxSize - 1;
+                memcpy(ppValues[i], p, copyLen);
+                ppValues[i][copyLen] = '\0';
+            }
+            p += valueLen;
+        }
+        return n < count ? (int)n : (int)count;
+    }
+    return -1;
+}
+
+/**
+ */
+int OSCC_getValues(const char *pHostAddress, const char **ppVariables, char **ppValues,
+                   unsigned int count, unsigned int valueMaxSize)
+{
+    int len = OSCC_packRead(pBufferMsgPack, HTTP_CLIENT_BUFFER_SIZE, ppVariables, count);
+    unsigned int i;
+
+    for (i = 0; i < count && valueMaxSize > 0; i++)
+        *ppValues[i] = '\0';
+    if (len < 0)
+        return 0;
+
+    len = OSCC_post(pHostAddress, "/cgi-bin/msgpack.cgi", MSGPACK_CONTENT_TYPE, pBufferMsgPack, len, pBufferIn, HTTP_CLIENT_BUFFER_SIZE);
+    return len >= 0 && OSCC_unpackValues(pBufferIn, len, "read", ppValues, count, valueMaxSize) == (int)count;
+}
+
+/**
+ */
+int OSCC_setValues(const char *pHostAddress, const char **ppVariables, const char **ppValues, unsigned int count)
+{
+    int len = OSCC_packWrite(pBufferMsgPack, HTTP_CLIENT_BUFFER_SIZE, ppVariables, ppValues, count);
+
+    if (len < 0)
+        return 0;
+
+    len = OSCC_post(pHostAddress, "/cgi-bin/msgpack.cgi", MSGPACK_CONTENT_TYPE, pBufferMsgPack, len, pBufferIn, HTTP_CLIENT_BUFFER_SIZE);
+    return len >= 0 && OSCC_unpackValues(pBufferIn, len, "write", NULL, 0, 0) == 0;
+}
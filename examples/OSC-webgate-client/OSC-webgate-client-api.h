@@ -23,6 +23,10 @@
  *
  *  This application uses HTTPClient by Eitan Michaelson but you can use
  *  any HTTP client you want.
+ *
+ *  OSCC_getValue() and OSCC_setValue() use getValue.cgi and setValue.cgi,
+ *  OSCC_getValues() and OSCC_setValues() read or write several variables
+ *  with one MessagePack request to msgpack.cgi.
  * 
  *  @author Frédéric Bourgeois
  *  @version 1.0
@@ -61,4 +65,76 @@ int OSCC_getValue(const char *pHostAddress, const char *pVariable, char *pValue,
  */
 int OSCC_setValue(const char *pHostAddress, const char *pVariable, const char *pValue);
 
+/**
+ * @brief Sends a POST request to OSC-webgate and receives the response.
+ * @param pHostAddress OSC-webgate address including port, e.g. localhost:8080
+ * @param pPath Path of the request, e.g. /cgi-bin/msgpack.cgi
+ * @param pContentType Content type of the request
+ * @param pData Body of the request
+ * @param len Length of the body
+ * @param pReceived Buffer where the response is stored
+ * @param receiveMax Size of pReceived
+ * @return Length of the response, -1 on error
+ */
+int OSCC_post(const char *pHostAddress, const char *pPath, const char *pContentType,
+              const char *pData, unsigned int len, char *pReceived, unsigned int receiveMax);
+
+/**
+ * @brief Encodes a msgpack.cgi request reading variables: {"read":[variables]}.
+ * @param pBuf Buffer receiving the request
+ * @param size Size of pBuf
+ * @param ppVariables Variable names
+ * @param count Number of variables
+ * @return Length of the request, -1 if pBuf is too small
+ */
+int OSCC_packRead(char *pBuf, unsigned int size, const char **ppVariables, unsigned int count);
+
+/**
+ * @brief Encodes a msgpack.cgi request writing variables: {"write":{variable:value}}.
+ * @param pBuf Buffer receiving the request
+ * @param size Size of pBuf
+ * @param ppVariables Variable names
+ * @param ppValues New values
+ * @param count Number of variables
+ * @return Length of the request, -1 if pBuf is too small
+ */
+int OSCC_packWrite(char *pBuf, unsigned int size, const char **ppVariables, const char **ppValues, unsigned int count);
+
+/**
+ * @brief Decodes the values of a msgpack.cgi response.
+ * The response is a map, the member "read" or "write" is an array of the
+ * values in the order of the request.
+ * @param pData Response
+ * @param len Length of the response
+ * @param pMember "read" or "write"
+ * @param ppValues Buffers receiving the values
+ * @param count Number of buffers
+ * @param valueMaxSize Size of each buffer, longer values are truncated
+ * @return Number of values decoded, -1 if the response is invalid
+ */
+int OSCC_unpackValues(const char *pData, unsigned int len, const char *pMember,
+                      char **ppValues, unsigned int count, unsigned int valueMaxSize);
+
+/**
+ * @brief Gets the values of several variables with one msgpack.cgi request.
+ * @param pHostAddress OSC-webgate address including port, e.g. localhost:8080
+ * @param ppVariables Variable names
+ * @param ppValues Buffers receiving the values, empty strings if not found
+ * @param count Number of variables
+ * @param valueMaxSize Maximal size of each buffer of ppValues
+ * @return 1 on success
+ */
+int OSCC_getValues(const char *pHostAddress, const char **ppVariables, char **ppValues,
+                   unsigned int count, unsigned int valueMaxSize);
+
+/**
+ * @brief Sets new values of several variables with one msgpack.cgi request.
+ * @param pHostAddress OSC-webgate address including port, e.g. localhost:8080
+ * @param ppVariables Variable names
+ * @param ppValues New values
+ * @param count Number of variables
+ * @return 1 on success
+ */
+int OSCC_setValues(const char *pHostAddress, const char **ppVariables, const char **ppValues, unsigned int count);
+
 #endif // _OSC_WEBGATE_CLIENT_API_H_
@@ -0,0 +1,372 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file OSC-webgate-client-bench.c
+ *  @brief Compares json.cgi and msgpack.cgi for a C client.
+ *
+ *  For batches of reads and writes, prints the size of the requests and
+ *  responses and the time to encode a request and to decode the values of
+ *  its response, with JSON (json.cgi) and MessagePack (msgpack.cgi). JSON is
+ *  decoded with the parser of OSC-webgate (src/ujsonpars.c), MessagePack
+ *  with OSCC_unpackValues().
+ *
+ *  The responses are built like OSC-webgate builds them. With a host, the
+ *  requests are also sent to OSC-webgate: the sizes are then the ones of the
+ *  responses received and the round trip time of a request is printed.
+ *
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "OSC-webgate-client-api.h"
+#include "ujsonpars.h"
+
+/** Size of the request and response buffers */
+#define BENCH_BUFFER_SIZE   65536
+
+/** Size of a value buffer */
+#define BENCH_VALUE_SIZE    64
+
+/** Maximal number of variables of a batch */
+#define BENCH_COUNT_MAX     100
+
+/** Number of encodings or decodings of a round */
+#define BENCH_ROUND_COUNT   1000
+
+/** Number of rounds, the fastest one is printed */
+#define BENCH_ROUNDS        20
+
+/** Number of requests sent to measure the round trip time */
+#define BENCH_REQUESTS      200
+
+/** @brief Decoding state of a json.cgi response */
+typedef struct t_JsonValues
+{
+    char **ppValues;        /**< buffers receiving the values */
+    unsigned int count;     /**< number of buffers */
+    unsigned int found;     /**< number of values decoded */
+} T_JsonValues, *PT_JsonValues;
+
+/** Variable names */
+static const char *pNames[BENCH_COUNT_MAX];
+
+/** Values written */
+static const char *pWriteValues[BENCH_COUNT_MAX];
+
+/** Buffers of the values decoded */
+static char *pValues[BENCH_COUNT_MAX];
+
+/**
+ * Get the time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Append a JSON string with its quotes, return the new position or -1.
+ */
+static int jsonAppendStr(char *pBuf, int size, int pos, const char *pStr)
+{
+    if (pos < 0 || pos + 1 >= size)
+        return -1;
+    pBuf[pos++] = '"';
+    for (; *pStr; pStr++)
+    {
+        unsigned char c = *pStr;
+        if (pos + 7 >= size)
+            return -1;
+        if (c == '"' || c == '\\')
+        {
+            pBuf[pos++] = '\\';
+            pBuf[pos++] = c;
+        }
+        else if (c < 0x20)
+        {
+            pos += sprintf(pBuf + pos, "\\u%04x", c);
+        }
+        else
+        {
+            pBuf[pos++] = c;
+        }
+    }
+    pBuf[pos++] = '"';
+    return pos;
+}
+
+/**
+ * Append text, return the new position or -1.
+ */
+static int jsonAppend(char *pBuf, int size, int pos, const char *pText)
+{
+    int len = strlen(pText);
+
+    if (pos < 0 || pos + len > size)
+        return -1;
+    memcpy(pBuf + pos, pText, len);
+    return pos + len;
+}
+
+/**
+ * Encode a json.cgi request (pValues NULL for a read) or response (pMember
+ * "read" or "write" and the values of the variables).
+ */
+static int jsonPack(char *pBuf, int size, const char *pMember, const char **ppVariables, const char **ppValues, int count)
+{
+    int pos, i;
+
+    pos = jsonAppend(pBuf, size, 0, "{\"version\":\"1\",\"");
+    pos = jsonAppend(pBuf, size, pos, pMember);
+    pos = jsonAppend(pBuf, size, pos, "\":[");
+    for (i = 0; i < count; i++)
+    {
+        pos = jsonAppend(pBuf, size, pos, i ? ",{\"var\":" : "{\"var\":");
+        pos = jsonAppendStr(pBuf, size, pos, ppVariables[i]);
+        if (ppValues)
+        {
+            pos = jsonAppend(pBuf, size, pos, ",\"val\":");
+            pos = jsonAppendStr(pBuf, size, pos, ppValues[i]);
+        }
+        pos = jsonAppend(pBuf, size, pos, "}");
+    }
+    return jsonAppend(pBuf, size, pos, "]}");
+}
+
+/**
+ * JSON callback storing the "val" members.
+ */
+static void jsonValue(void *pJson, char *pPair, char *pValue)
+{
+    PT_JsonValues pState = (PT_JsonValues)((PT_uJson)pJson)->pObject;
+
+    if (strcmp(pPair, "val") == 0)
+    {
+        if (pState->found < pState->count)
+        {
+            strncpy(pState->ppValues[pState->found], pValue, BENCH_VALUE_SIZE - 1);
+            pState->ppValues[pState->found][BENCH_VALUE_SIZE - 1] = '\0';
+        }
+        pState->found++;
+    }
+}
+
+/**
+ * Decode the values of a json.cgi response in place, return their number or -1.
+ */
+static int jsonUnpackValues(char *pData, int len, char **ppValues, int count)
+{
+    T_JsonValues state = { ppValues, count, 0 };
+    T_uJson json;
+
+    UJSON_init(&json);
+    json.pObject = &state;
+    json.value = jsonValue;
+    if (UJSON_parseBuffer(&json, pData, len, 1) < 0)
+        return -1;
+    return state.found;
+}
+
+/**
+ * Build a MessagePack response of OSC-webgate: {member:[values]}.
+ */
+static int msgpackPackResponse(char *pBuf, int size, const char *pMember, const char **ppValues, int count)
+{
+    // a response has the same layout as a read request of the values
+    int len = OSCC_packRead(pBuf, size, ppValues, count);
+
+    if (len < 0 || strcmp(pMember, "read") == 0)
+        return len;
+
+    // "write" is one byte longer than "read"
+    if (len + 1 > size)
+        return -1;
+    memmove(pBuf + 7, pBuf + 6, len - 6);
+    memcpy(pBuf + 1, "\xa5write", 6);
+    return len + 1;
+}
+
+/**
+ * Time a function call in nanoseconds (fastest of BENCH_ROUNDS rounds).
+ */
+#define BENCH_TIME(result, statement)                               \
+    do                                                              \
+    {                                                               \
+        int r_, i_;                                                 \
+        result = 1e9;                                               \
+        for (r_ = 0; r_ < BENCH_ROUNDS; r_++)                       \
+        {                                                           \
+            double t_ = now();                                      \
+            for (i_ = 0; i_ < BENCH_ROUND_COUNT; i_++)              \
+            {                                                       \
+                statement;                                          \
+            }                                                       \
+            t_ = (now() - t_) * 1e9 / BENCH_ROUND_COUNT;            \
+            if (t_ < result)                                        \
+                result = t_;                                        \
+        }                                                           \
+    }                                                               \
+    while (0)
+
+/**
+ * Send a request BENCH_REQUESTS times, return the mean round trip time in
+ * microseconds and the response in pResponse, -1 on error.
+ */
+static double roundTrip(const char *pHost, int msgpack, const char *pRequest, int len, char *pResponse, int *pResponseLen)
+{
+    double start = now();
+    int i;
+
+    for (i = 0; i < BENCH_REQUESTS; i++)
+    {
+        *pResponseLen = OSCC_post(pHost, msgpack ? "/cgi-bin/msgpack.cgi" : "/cgi-bin/json.cgi",
+                                  msgpack ? "application/x-msgpack" : "application/json",
+                                  pRequest, len, pResponse, BENCH_BUFFER_SIZE);
+        if (*pResponseLen < 0)
+            return -1;
+    }
+    return (now() - start) * 1e6 / BENCH_REQUESTS;
+}
+
+/**
+ * Benchmark a batch of reads or writes with both formats.
+ */
+static int benchBatch(const char *pHost, int write, int count, char *pRequest, char *pResponse, char *pCopy)
+{
+    const char *pMember = write ? "write" : "read";
+    int msgpack;
+
+    for (msgpack = 0; msgpack <= 1; msgpack++)
+    {
+        int reqLen, respLen, decoded = 0;
+        double encodeNs, decodeNs, tripUs = 0;
+
+        // encode the request
+        if (msgpack && write)
+            BENCH_TIME(encodeNs, reqLen = OSCC_packWrite(pRequest, BENCH_BUFFER_SIZE, pNames, pWriteValues, count));
+        else if (msgpack)
+            BENCH_TIME(encodeNs, reqLen = OSCC_packRead(pRequest, BENCH_BUFFER_SIZE, pNames, count));
+        else
+            BENCH_TIME(encodeNs, reqLen = jsonPack(pRequest, BENCH_BUFFER_SIZE, pMember, pNames, write ? pWriteValues : NULL, count));
+        if (reqLen < 0)
+            return -1;
+
+        // get the response
+        if (pHost)
+        {
+            tripUs = roundTrip(pHost, msgpack, pRequest, reqLen, pResponse, &respLen);
+            if (tripUs < 0)
+            {
+                printf("%s: no response\n", pHost);
+                return -1;
+            }
+        }
+        else if (msgpack)
+        {
+            respLen = msgpackPackResponse(pResponse, BENCH_BUFFER_SIZE, pMember, pWriteValues, count);
+        }
+        else
+        {
+            respLen = jsonPack(pResponse, BENCH_BUFFER_SIZE, pMember, pNames, pWriteValues, count);
+        }
+        if (respLen < 0)
+            return -1;
+
+        // decode the values, the JSON parser modifies its buffer
+        if (msgpack)
+        {
+            BENCH_TIME(decodeNs, decoded = OSCC_unpackValues(pResponse, respLen, pMember, pValues, count, BENCH_VALUE_SIZE));
+        }
+        else
+        {
+            BENCH_TIME(decodeNs, memcpy(pCopy, pResponse, respLen);
+                                 decoded = jsonUnpackValues(pCopy, respLen, pValues, count));
+        }
+        if (decoded != count)
+        {
+            printf("%s %d: %d values decoded\n", pMember, count, decoded);
+            return -1;
+        }
+
+        printf("%-6s %4d  %-12s %8d %8d %10.0f %10.0f", pMember, count, msgpack ? "msgpack.cgi" : "json.cgi",
+               reqLen, respLen, encodeNs, decodeNs);
+        if (pHost)
+            printf(" %10.0f", tripUs);
+        printf("\n");
+    }
+    return 0;
+}
+
+/**
+ */
+int main(int argc, char *argv[])
+{
+    static const int counts[] = { 1, 10, 100 };
+    char *pRequest = malloc(BENCH_BUFFER_SIZE);
+    char *pResponse = malloc(BENCH_BUFFER_SIZE);
+    char *pCopy = malloc(BENCH_BUFFER_SIZE);
+    const char *pHost = argc >= 2 ? argv[1] : NULL;
+    unsigned int i, c;
+    int write, ret = 0;
+
+    if (argc > 2 || (pHost && pHost[0] == '-'))
+    {
+        printf("usage: OSC-webgate-client-bench [host[:port]]\n");
+        return -1;
+    }
+
+    for (i = 0; i < BENCH_COUNT_MAX; i++)
+    {
+        char *pName = malloc(32);
+        char *pValue = malloc(8);
+        sprintf(pName, "/mixer/ch%u/fader", i);
+        sprintf(pValue, "0.%03u", i * 37 % 1000);
+        pNames[i] = pName;
+        pWriteValues[i] = pValue;
+        pValues[i] = malloc(BENCH_VALUE_SIZE);
+    }
+
+    OSCC_init();
+
+    // write first, so that the reads return the values written
+    printf("                           request  response  encode ns  decode ns%s\n", pHost ? "  round trip us" : "");
+    for (write = 1; write >= 0 && ret == 0; write--)
+    {
+        for (c = 0; c < sizeof(counts) / sizeof(counts[0]) && ret == 0; c++)
+            ret = benchBatch(pHost, write, counts[c], pRequest, pResponse, pCopy);
+    }
+
+    OSCC_deinit();
+
+    for (i = 0; i < BENCH_COUNT_MAX; i++)
+    {
+        free((char*)pNames[i]);
+        free((char*)pWriteValues[i]);
+        free(pValues[i]);
+    }
+    free(pRequest);
+    free(pResponse);
+    free(pCopy);
+    return ret;
+}
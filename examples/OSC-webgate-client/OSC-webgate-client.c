@@ -36,11 +36,26 @@
 // IP and port of OSC-webgate, e.g. localhost:80
 static char host[256];
 
+// Number of information variables
+#define INFO_COUNT  8
+
+// Information variables about the server
+static const char *pInfoNames[INFO_COUNT] =
+{
+    "APP_NAME", "APP_VERSION", "SERVER_IP", "SERVER_PORT",
+    "USER_PREFIX", "OSC_HOST", "OSC_PORT", "OSC_PREFIX"
+};
+
 /**
  */
 int main(int argc, char *argv[])
 {
     char value[256] = "";
+    char infoValues[INFO_COUNT][256];
+    char *pInfoValues[INFO_COUNT];
+    const char *pNames[2] = { "DPU.myIntVar", "DPU.myStrVar" };
+    const char *pValues[2] = { "42", "Both written with msgpack.cgi" };
+    int i;
 
     // check arguments
     if (argc != 2)
@@ -53,15 +68,18 @@ int main(int argc, char *argv[])
     // initializes the API
     OSCC_init();
 
-    // Print some information about the server
-    printf("APP_NAME: %s\n", OSCC_getValue(host, "APP_NAME", value, 256) ? value : "---");
-    printf("APP_VERSION: %s\n", OSCC_getValue(host, "APP_VERSION", value, 256) ? value : "---");
-    printf("SERVER_IP: %s\n", OSCC_getValue(host, "SERVER_IP", value, 256) ? value : "---");
-    printf("SERVER_PORT: %s\n", OSCC_getValue(host, "SERVER_PORT", value, 256) ? value : "---");
-    printf("USER_PREFIX: %s\n", OSCC_getValue(host, "USER_PREFIX", value, 256) ? value : "---");
-    printf("OSC_HOST: %s\n", OSCC_getValue(host, "OSC_HOST", value, 256) ? value : "---");
-    printf("OSC_PORT: %s\n", OSCC_getValue(host, "OSC_PORT", value, 256) ? value : "---");
-    printf("OSC_PREFIX: %s\n", OSCC_getValue(host, "OSC_PREFIX", value, 256) ? value : "---");
+    // Print some information about the server, read with one msgpack.cgi request
+    for (i = 0; i < INFO_COUNT; i++)
+        pInfoValues[i] = infoValues[i];
+    if (OSCC_getValues(host, pInfoNames, pInfoValues, INFO_COUNT, 256))
+    {
+        for (i = 0; i < INFO_COUNT; i++)
+            printf("%s: %s\n", pInfoNames[i], infoValues[i]);
+    }
+    else
+    {
+        printf("msgpack.cgi: ---\n");
+    }
     printf("\n");
 
     // Read and write DPU.myIntVar
@@ -96,6 +114,13 @@ int main(int argc, char *argv[])
     }
     printf("\n");
 
+    // Write both variables with one msgpack.cgi request
+    if (OSCC_setValues(host, pNames, pValues, 2))
+    {
+        printf("Set myIntVar = %s, myStrVar = %s\n", pValues[0], pValues[1]);
+    }
+    printf("\n");
+
     // De-initialize the API
     OSCC_deinit();
 
@@ -424,6 +424,83 @@ int OSC_writeStringArg(OSCbuf *buf, const char *arg) {
 
 }
 
+static void Write8Bytes(char *dest, unsigned long long value) {
+    int4byte *intp = (int4byte *) dest;
+
+    /* Most significant word first, each word in network byte order */
+    intp[0] = htonl((int4byte) (value >> 32));
+    intp[1] = htonl((int4byte) value);
+}
+
+int OSC_writeInt64Arg(OSCbuf *buf, long long arg) {
+    CheckOverflow(buf, 8);
+    if (CheckTypeTag(buf, 'h')) return 9;
+
+    Write8Bytes(buf->bufptr, (unsigned long long) arg);
+    buf->bufptr += 8;
+
+    buf->gettingFirstUntypedArg = 0;
+    return 0;
+}
+
+int OSC_writeDoubleArg(OSCbuf *buf, double arg) {
+    unsigned long long bits;
+
+    CheckOverflow(buf, 8);
+    if (CheckTypeTag(buf, 'd')) return 9;
+
+    /* Pretend arg is a 64 bit int so we can byte swap it */
+    memcpy(&bits, &arg, 8);
+    Write8Bytes(buf->bufptr, bits);
+    buf->bufptr += 8;
+
+    buf->gettingFirstUntypedArg = 0;
+    return 0;
+}
+
+int OSC_writeTimeTagArg(OSCbuf *buf, OSCTimeTag arg) {
+    CheckOverflow(buf, 8);
+    if (CheckTypeTag(buf, 't')) return 9;
+
+#ifdef HAS8BYTEINT
+    Write8Bytes(buf->bufptr, (unsigned long long) arg);
+#else
+    Write8Bytes(buf->bufptr, ((unsigned long long) arg.seconds << 32) | arg.fraction);
+#endif
+    buf->bufptr += 8;
+
+    buf->gettingFirstUntypedArg = 0;
+    return 0;
+}
+
+int OSC_writeBlobArg(OSCbuf *buf, const void *data, int len) {
+    int paddedLength;
+
+    if (len < 0) {
+	OSC_errorMessage = "Negative blob size";
+	return 10;
+    }
+
+    paddedLength = OSC_effectiveBlobLength(len);
+    CheckOverflow(buf, paddedLength);
+    if (CheckTypeTag(buf, 'b')) return 9;
+
+    *((int4byte *) buf->bufptr) = htonl(len);
+    memcpy(buf->bufptr + 4, data, len);
+    memset(buf->bufptr + 4 + len, 0, paddedLength - 4 - len);
+    buf->bufptr += paddedLength;
+
+    buf->gettingFirstUntypedArg = 0;
+    return 0;
+}
+
+int OSC_writeNoDataArg(OSCbuf *buf, char type) {
+    if (CheckTypeTag(buf, type)) return 9;
+
+    buf->gettingFirstUntypedArg = 0;
+    return 0;
+}
+
 /* String utilities */
 /*
 static int strlen(char *s) {
@@ -156,6 +156,14 @@ int ChangeOutermostTimestamp(OSCbuf *buf, OSCTimeTag tt);
 	    OSC_writeFloatArgs()
 	    OSC_writeIntArg()
 	    OSC_writeStringArg()
+	    OSC_writeInt64Arg()
+	    OSC_writeDoubleArg()
+	    OSC_writeTimeTagArg()
+	    OSC_writeBlobArg()
+	    OSC_writeNoDataArg()
+
+	  The last five types (OSC 1.1) can't be told apart without a type
+	  tag string, so use OSC_writeAddressAndTypes() for them.
 
 	- Now your message is complete; you can send out the buffer or you can
 	  add another message to it.
@@ -171,6 +179,14 @@ int OSC_writeFloatArg(OSCbuf *buf, float arg);
 int OSC_writeFloatArgs(OSCbuf *buf, int numFloats, float *args);
 int OSC_writeIntArg(OSCbuf *buf, int4byte arg);
 int OSC_writeStringArg(OSCbuf *buf, const char *arg);
+int OSC_writeInt64Arg(OSCbuf *buf, long long arg);
+int OSC_writeDoubleArg(OSCbuf *buf, double arg);
+int OSC_writeTimeTagArg(OSCbuf *buf, OSCTimeTag arg);
+int OSC_writeBlobArg(OSCbuf *buf, const void *data, int len);
+
+/* Write an argument which has no data, only a type tag: 'T' (true),
+   'F' (false) or 'N' (nil). */
+int OSC_writeNoDataArg(OSCbuf *buf, char type);
 
 extern char *OSC_errorMessage;
 
@@ -178,3 +194,8 @@ extern char *OSC_errorMessage;
    string?  The length of the string, plus the null char, plus any padding
    needed for 4-byte alignment. */ 
 int OSC_effectiveStringLength(const char *string);
+
+/* How many bytes will be needed in the OSC format to hold a blob with the
+   given number of data bytes?  The int32 size count, plus the data, plus
+   any padding needed for 4-byte alignment. */
+int OSC_effectiveBlobLength(int blobDataSize);
@@ -17,11 +17,20 @@
  *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
  ****************************************************************************/
 
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include "datapool.h"
+#include "route.h"
+#include "strbuf.h"
 #include "utils.h"
 #include "cgi.h"
 
+#if OSC_EN
+  #include "osc.h"
+  #include "osc_route.h"
+#endif
+
 /****************************************************************************/
 
 /**
@@ -91,10 +100,25 @@ void CGI_processGetValue(struct mg_connection *conn)
     {
         // get value
         const char *pValue;
+        DP_HANDLE handle;
+        unsigned int tag;
         str_decode((char*)conn->query_string);
-        pValue = DP_getValue(conn->query_string);
-        mg_send_header(conn, "Content-Type", "text/plain");
-        mg_send_data(conn, pValue, strlen(pValue));
+        handle = DP_getHandle(conn->query_string);
+        if (handle)
+        {
+            unsigned long version = DP_getVersion(handle);
+            pValue = DP_getValueByHandle(handle);
+            tag = str_hash(&version, sizeof(version));
+        }
+        else
+        {
+            // volatile variable, the tag depends on the value
+            pValue = DP_getValue(conn->query_string);
+            tag = str_hash(pValue, strlen(pValue));
+        }
+        if (CGI_sendETag(conn, tag))
+            return;
+        CGI_sendResponse(conn, "text/plain", pValue, strlen(pValue));
     }
     else
     {
@@ -149,3 +173,224 @@ void CGI_processSetValue(struct mg_connection *conn)
         mg_send_data(conn, "", 0);
     }
 }
+
+#if OSC_EN
+
+/** @brief OSC host of the messages of an OSC packet */
+typedef struct t_CGI_OSCRoute
+{
+    const T_OSCROUTE_Destination *pDestination;    /**< OSC host of the first message */
+    int routed;                                     /**< cleared if a message is not routed to this host */
+} T_CGI_OSCRoute, *PT_CGI_OSCRoute;
+
+/**
+ * @brief Check that all messages of an OSC packet are routed to the same OSC host.
+ * @param pObject Pointer to a T_CGI_OSCRoute
+ * @param pAddress OSC address
+ * @param numArgs Number of arguments
+ * @param pArgs Arguments
+ */
+static void checkOSCMessage(void *pObject, const char *pAddress, int numArgs, PT_OSC_ArgType pArgs)
+{
+    PT_CGI_OSCRoute pRoute = (PT_CGI_OSCRoute)pObject;
+    const T_OSCROUTE_Destination *pDestination = OSCROUTE_find(pAddress);
+
+    if (!pRoute->pDestination)
+        pRoute->pDestination = pDestination;
+    if (!pDestination || pDestination != pRoute->pDestination)
+        pRoute->routed = 0;
+}
+
+/**
+ * @brief Write the first argument of a message of an OSC packet to the data-pool.
+ * @param pObject Not used
+ * @param pAddress OSC address
+ * @param numArgs Number of arguments
+ * @param pArgs Arguments
+ */
+static void updateOSCMessage(void *pObject, const char *pAddress, int numArgs, PT_OSC_ArgType pArgs)
+{
+    char value[DP_VALUE_LENGTH_MAX];
+
+    if (numArgs > 0)
+    {
+        OSC_argToString(&pArgs[0], value, DP_VALUE_LENGTH_MAX);
+        DP_updateValue(pAddress, value);
+    }
+}
+
+/**
+ */
+void CGI_processOSC(struct mg_connection *conn)
+{
+    T_CGI_OSCRoute route = { NULL, 1 };
+
+    // validate the whole packet before anything is written
+    if (OSC_parsePacket(conn->content, (int)conn->content_len, checkOSCMessage, &route) || !route.routed || !route.pDestination)
+    {
+        mg_send_status(conn, route.routed && route.pDestination ? 400 : 403);
+        CGI_sendResponse(conn, "text/plain", NULL, 0);
+        return;
+    }
+
+    OSC_parsePacket(conn->content, (int)conn->content_len, updateOSCMessage, NULL);
+
+    // forward the original packet
+    if (OSC_sendPacket(route.pDestination->host, route.pDestination->port, conn->content, (int)conn->content_len))
+        mg_send_status(conn, 502);
+    else
+        mg_send_status(conn, 204);
+    CGI_sendResponse(conn, "text/plain", NULL, 0);
+}
+
+#endif // OSC_EN
+
+/**
+ */
+void CGI_processRoutes(struct mg_connection *conn)
+{
+    T_StrBuf response;
+    T_RouteStats stats;
+    char line[64];
+    int i;
+
+    STRBUF_init(&response);
+    STRBUF_appendStr(&response, "{\"version\":\"1\",\"routes\":[");
+    for (i = 0; ROUTE_getStats(i, &stats) == 0; i++)
+    {
+        if (i)
+            STRBUF_append(&response, ",", 1);
+        STRBUF_appendStr(&response, "{\"path\":\"");
+        STRBUF_appendJsonString(&response, stats.pPath, strlen(stats.pPath));
+        sprintf(line, "\",\"requests\":%lu,\"rejected\":%lu,", stats.requests, stats.rejected);
+        STRBUF_appendStr(&response, line);
+        sprintf(line, "\"throttled\":%lu,", stats.throttled);
+        STRBUF_appendStr(&response, line);
+        sprintf(line, "\"total_us\":%llu,\"max_us\":%lu}", stats.totalUs, stats.maxUs);
+        STRBUF_appendStr(&response, line);
+    }
+    if (STRBUF_appendStr(&response, "]}"))
+    {
+        mg_send_status(conn, 500);
+        CGI_sendResponse(conn, "text/plain", NULL, 0);
+    }
+    else
+    {
+        CGI_sendResponse(conn, "application/json", response.pData, response.len);
+    }
+    STRBUF_free(&response);
+}
+
+/****************************************************************************/
+
+/**
+ * @brief Define a route handler which calls a CGI function and returns MG_TRUE.
+ * @param name Name of the route handler
+ * @param function CGI function
+ */
+#define CGI_ROUTE_HANDLER(name, function) \
+    static int name(struct mg_connection *conn) { function(conn); return MG_TRUE; }
+
+CGI_ROUTE_HANDLER(routeJSON, CGI_processJSON)
+CGI_ROUTE_HANDLER(routeGetValue, CGI_processGetValue)
+CGI_ROUTE_HANDLER(routeSetValue, CGI_processSetValue)
+CGI_ROUTE_HANDLER(routeRoutes, CGI_processRoutes)
+#if CGI_MSGPACK_EN
+CGI_ROUTE_HANDLER(routeMsgPack, CGI_processMsgPack)
+#endif
+#if OSC_EN
+CGI_ROUTE_HANDLER(routeOSC, CGI_processOSC)
+#endif
+
+/** Routes of the CGI requests */
+static const T_Route routes[] =
+{
+    { ROUTE_CGI_PATH "json.cgi", ROUTE_POST, ROUTE_LIMIT_READ, routeJSON, CGI_recvJSON, NULL, CGI_closeJSON },
+  #if CGI_MSGPACK_EN
+    { ROUTE_CGI_PATH "msgpack.cgi", ROUTE_POST, ROUTE_LIMIT_WRITE, routeMsgPack, NULL, NULL, NULL },
+  #endif
+  #if OSC_EN
+    { ROUTE_CGI_PATH "osc.cgi", ROUTE_POST, ROUTE_LIMIT_WRITE, routeOSC, NULL, NULL, NULL },
+  #endif
+    { ROUTE_CGI_PATH "getValue.cgi", ROUTE_GET | ROUTE_POST, ROUTE_LIMIT_READ, routeGetValue, NULL, NULL, NULL },
+    { ROUTE_CGI_PATH "setValue.cgi", ROUTE_GET | ROUTE_POST, ROUTE_LIMIT_WRITE, routeSetValue, NULL, NULL, NULL },
+    { ROUTE_CGI_PATH "routes.cgi", ROUTE_GET, ROUTE_LIMIT_NONE, routeRoutes, NULL, NULL, NULL },
+    { NULL, 0, 0, NULL, NULL, NULL, NULL }
+};
+
+/**
+ */
+void CGI_init(void)
+{
+    int i;
+    for (i = 0; routes[i].pPath; i++)
+        ROUTE_register(&routes[i]);
+}
+
+/****************************************************************************/
+
+/**
+ */
+void CGI_sendResponse(struct mg_connection *conn, const char *pType, const void *pData, size_t len)
+{
+    char length[24];
+
+    snprintf(length, sizeof(length), "%lu", (unsigned long)len);
+    mg_send_header(conn, "Content-Type", pType);
+    mg_send_header(conn, "Content-Length", length);
+    mg_write(conn, "\r\n", 2);
+    if (len)
+        mg_write(conn, pData, (int)len);
+}
+
+/**
+ * @brief Format the ETag of a read response.
+ * Tags are salted with the start time of the server.
+ * @param tag Tag computed from the versions of the variables read
+ * @param pETag Buffer receiving the quoted tag, 16 characters at least
+ */
+static void formatETag(unsigned int tag, char *pETag)
+{
+    static unsigned int salt = 0;
+
+    if (!salt)
+        salt = (unsigned int)time(NULL);
+    snprintf(pETag, 16, "\"%08x\"", tag ^ salt);
+}
+
+/**
+ */
+int CGI_checkETag(struct mg_connection *conn, unsigned int tag)
+{
+    const char *pIfNoneMatch = mg_get_header(conn, "If-None-Match");
+    char etag[16];
+
+    if (!pIfNoneMatch)
+        return 0;
+
+    formatETag(tag, etag);
+    if (strstr(pIfNoneMatch, etag) || strcmp(pIfNoneMatch, "*") == 0)
+    {
+        // no body and no chunked encoding
+        mg_send_status(conn, 304);
+        mg_send_header(conn, "ETag", etag);
+        mg_write(conn, "\r\n", 2);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ */
+int CGI_sendETag(struct mg_connection *conn, unsigned int tag)
+{
+    char etag[16];
+
+    if (CGI_checkETag(conn, tag))
+        return 1;
+
+    formatETag(tag, etag);
+    mg_send_header(conn, "ETag", etag);
+    mg_send_header(conn, "Cache-Control", "no-cache");
+    return 0;
+}
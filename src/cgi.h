@@ -37,12 +37,40 @@
  * @{
  */
 
+/**
+ * @brief Register the routes of the CGI requests (see ROUTE_register()).
+ * - json.cgi (POST, read rate, write rate with "write" or "transaction"): CGI_processJSON()
+ * - msgpack.cgi (POST, write rate): CGI_processMsgPack()
+ * - osc.cgi (POST, write rate): CGI_processOSC()
+ * - getValue.cgi (GET, POST, read rate): CGI_processGetValue()
+ * - setValue.cgi (GET, POST, write rate): CGI_processSetValue()
+ * - routes.cgi (GET, no rate limit): CGI_processRoutes()
+ */
+void CGI_init(void);
+
+/**
+ * @brief CGI request to get the statistics of all routes.
+ * The response is a JSON object with the number of requests, the number of
+ * requests rejected because of their method, the number of requests over
+ * the rate limit and the time spent in the handler (total and maximum in
+ * microseconds) per route:
+ *
+ *  <PRE>
+ *  {"version":"1","routes":[{"path":"/cgi-bin/json.cgi","requests":120,"rejected":0,"throttled":0,"total_us":5210,"max_us":310}]}
+ *  </PRE>
+ * @param conn HTTP request containing incoming data
+ */
+void CGI_processRoutes(struct mg_connection *conn);
+
  /**
  * @brief CGI request to get one or more variable values.
  * <b>Examples</b>
  * <pre>
  * http://server_url/cgi-bin/getValue.cgi?variable
  * </pre>
+ * The response carries an ETag computed from the version of the variable,
+ * a request with a matching If-None-Match header is answered with
+ * "304 Not Modified".
  * @param conn HTTP request containing incoming data
  */
 void CGI_processGetValue(struct mg_connection *conn);
@@ -111,10 +139,207 @@ void CGI_processSetValue(struct mg_connection *conn);
  *          ]
  *  }
  *  </PRE>
+ * <b>Request subscribing to variables (SESSION_EN):</b>
+ *
+ *  <PRE>
+ *  {
+ *   "version":"1",
+ *   "subscribe":[
+ *           {"var":"/osc/sb_fuzz/switch"},
+ *           {"prefix":"/osc/sb_delay/"}
+ *          ]
+ *  }
+ *  </PRE>
+ *
+ * <b>Response:</b>
+ *
+ *  <PRE>
+ *  {
+ *   "version":"1",
+ *   "session":"5d1c09a2",
+ *   "seq":"42",
+ *   "read":[
+ *           {"var":"/osc/sb_fuzz/switch","val":"1"},
+ *           {"var":"/osc/sb_delay/time","val":"250"}
+ *          ]
+ *  }
+ *  </PRE>
+ *
+ * <b>Request polling a session:</b>
+ *
+ *  <PRE>
+ *  {"version":"1","session":"5d1c09a2","since":"42"}
+ *  </PRE>
+ *
+ * The response has the same form as the one of the subscription. With
+ * "since", it contains only the variables written after the response which
+ * returned this "seq", volatile variables are always contained. Without
+ * "since", it contains all variables. An unknown or expired session (see
+ * SESSION_TIMEOUT) is answered with {"version":"1","error":"unknown session"},
+ * the client then subscribes again.
+ *
+ * <b>Request writing variables at once (transaction):</b>
+ *
+ *  <PRE>
+ *  {
+ *   "version":"1",
+ *   "delay":"0.05",
+ *   "transaction":[
+ *           {"var":"/osc/sb_fuzz/drive","val":"30"},
+ *           {"var":"/osc/sb_delay/time","val":"250"}
+ *          ]
+ *  }
+ *  </PRE>
+ *
+ * <b>Response:</b>
+ *
+ *  <PRE>
+ *  {
+ *   "version":"1",
+ *   "timetag":"dac2b5e40ccccccc",
+ *   "transaction":[
+ *           {"var":"/osc/sb_fuzz/drive","val":"30"},
+ *           {"var":"/osc/sb_delay/time","val":"250"}
+ *          ]
+ *  }
+ *  </PRE>
+ *
+ * All writes of a transaction are applied together once the request object
+ * is parsed, no other request sees a part of them. The values routed to the
+ * OSC host are sent in one bundle. Its time tag is either given by
+ * "timetag" (NTP format, 16 hex digits) or computed from "delay" (seconds
+ * from now), anywhere in the request. Without them the bundle is
+ * applied immediately. A transaction which does not fit in one bundle is
+ * not applied and answered with "error":"transaction too large".
+ *
+ * The response is rendered into one buffer and sent with a Content-Length
+ * header. Once a read request has been compiled (see CGI_getCacheStats()),
+ * its responses carry an ETag computed from the versions of the variables read
+ * and a request with a matching If-None-Match header is answered with
+ * "304 Not Modified".
  * @param conn HTTP request containing incoming data
  */
 void CGI_processJSON(struct mg_connection *conn);
 
+/**
+ * @brief Process a MessagePack request (msgpack.cgi).
+ * This is a compact binary alternative to CGI_processJSON() for clients
+ * written in C. The request is a map with the following members, all
+ * optional and processed in order:
+ *
+ * - "read": array of variable names. The response member "read" is an
+ *   array of the values in the same order.
+ * - "write": map of variable names and values (string, integer, float,
+ *   boolean or nil). The response member "write" is an array of the values
+ *   stored in the same order.
+ * - "subscribe" and "prefix" (SESSION_EN): arrays of variable names and
+ *   prefixes creating a session like the JSON member "subscribe".
+ * - "session" and "since" (SESSION_EN): unsigned integers polling a session
+ *   like the JSON members of the same name.
+ *
+ * For a subscription or a poll, the response members are "session" and
+ * "seq" (unsigned integers) and "changed", a map of variable names and
+ * values, or "error" if the session is unknown. Unknown request members
+ * are ignored. Invalid requests are answered with "400 Bad Request".
+ *
+ * <b>Example (shown as JSON):</b>
+ *
+ *  <PRE>
+ *  request:  {"read":["/osc/sb_fuzz/drive"],"write":{"/osc/sb_fuzz/clip":0.6}}
+ *  response: {"read":["26"],"write":["0.6"]}
+ *  </PRE>
+ * Requests and responses have the content type "application/x-msgpack".
+ * @param conn HTTP request containing incoming data
+ */
+void CGI_processMsgPack(struct mg_connection *conn);
+
+/**
+ * @brief Forward an OSC packet to its OSC host (osc.cgi).
+ * The body of the POST request is an OSC message or bundle. It is validated
+ * first, then the first argument of every message is written to the
+ * data-pool variable named like its address and the original packet is sent
+ * unchanged to the OSC host all its addresses are routed to (see OSCROUTE).
+ * The data-pool does not send the values again.
+ *
+ * The response has no body. The status is "204 No Content" on success,
+ * "400 Bad Request" for an invalid packet, "403 Forbidden" if an address
+ * is not routed or the addresses are routed to different OSC hosts and
+ * "502 Bad Gateway" if the packet could not be sent.
+ * @param conn HTTP request containing incoming data
+ */
+void CGI_processOSC(struct mg_connection *conn);
+
+/**
+ * @brief Parse the part of a JSON request received so far.
+ * Requests of at least CGI_STREAM_MIN_SIZE bytes are parsed while they are
+ * received and writes are applied as they are parsed, so the body is never
+ * buffered completely. The response is sent in parts of
+ * CGI_STREAM_FLUSH_SIZE bytes and completed by CGI_processJSON(). A pair and
+ * its value must not exceed CGI_STREAM_PAIR_MAX bytes. If the request fails
+ * after a part was sent, the response ends with "error":"request too large"
+ * for a larger pair, "too many requests" if it is throttled and
+ * "invalid request" for a syntax or processing error.
+ * @param conn HTTP request containing the data received so far (MG_RECV)
+ * @return Number of bytes consumed
+ */
+int CGI_recvJSON(struct mg_connection *conn);
+
+/**
+ * @brief Release a JSON request parsed while it was received.
+ * Called if the connection is closed before the request is complete.
+ * @param conn HTTP request
+ */
+void CGI_closeJSON(struct mg_connection *conn);
+
+/** @brief Statistics of the JSON response cache */
+typedef struct t_CGI_CacheStats
+{
+    unsigned long hits;             /**< number of requests answered from the cache */
+    unsigned long misses;           /**< number of requests not found in the cache */
+    unsigned long replays;          /**< number of misses answered from a compiled read list */
+} T_CGI_CacheStats, *PT_CGI_CacheStats;
+
+/**
+ * @brief Get the statistics of the JSON response cache.
+ * Read requests of variables which are not volatile (see DP_isVolatile()) are
+ * answered from the cache as long as the data-pool generation has not changed.
+ * Read requests are compiled once into a response template with variable
+ * handles, so after a change only the values are looked up again.
+ * @param pStats Structure receiving the statistics
+ */
+void CGI_getCacheStats(PT_CGI_CacheStats pStats);
+
+/**
+ * @brief Send a complete response with a Content-Length header.
+ * The response is written at once instead of in chunks.
+ * @param conn HTTP request
+ * @param pType Content type
+ * @param pData Body of the response, can be NULL if len is 0
+ * @param len Length of the body
+ */
+void CGI_sendResponse(struct mg_connection *conn, const char *pType, const void *pData, size_t len);
+
+/**
+ * @brief Answer "304 Not Modified" if the client has the current response.
+ * Nothing is sent otherwise, so the response can still fail with an error.
+ * @param conn HTTP request
+ * @param tag Tag computed from the versions of the variables read
+ * @return 1 if answered with "304 Not Modified", 0 otherwise
+ */
+int CGI_checkETag(struct mg_connection *conn, unsigned int tag);
+
+/**
+ * @brief Send the ETag header of a read response.
+ * If the If-None-Match header of the request contains the same tag, the
+ * request is answered with "304 Not Modified" and no body must follow.
+ * Tags are salted with the start time of the server, so tags of a previous
+ * run never match.
+ * @param conn HTTP request
+ * @param tag Tag computed from the versions of the variables read
+ * @return 1 if answered with "304 Not Modified", 0 if the response must follow
+ */
+int CGI_sendETag(struct mg_connection *conn, unsigned int tag);
+
 /** @} CGI */
 
 #endif // _CGI_H_
@@ -17,37 +17,295 @@
  *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
  ****************************************************************************/
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "datapool.h"
 #include "ujsonpars.h"
+#include "strbuf.h"
+#include "utils.h"
 #include "cgi.h"
+#include "route.h"
+#include "ratelimit.h"
+
+#if SESSION_EN
+  #include "session.h"
+#endif
+
+#if OSC_EN
+  #include "osc.h"
+#endif
 
 /****************************************************************************/
 
-/** Buffer size for parsing variables */
+/** Buffer size for the variable of a write */
 #define JPARSE_BUFFER_SIZE          256
 
-/** Used by the JSON parser to store a pair */
-static char gpPair[JPARSE_BUFFER_SIZE];
+/** @brief Placeholder for a value in a compiled response template */
+typedef struct t_JsonHole
+{
+    size_t    offset;               /**< position in the template where the value is inserted */
+    DP_HANDLE handle;               /**< handle of the variable, NULL if looked up by name */
+    size_t    variable;             /**< position of the variable name in the names buffer */
+} T_JsonHole, *PT_JsonHole;
+
+/** @brief Compiled read request: response template with placeholders for the values */
+typedef struct t_JsonReadList
+{
+    T_StrBuf    templ;              /**< response without the values */
+    T_StrBuf    names;              /**< names of the variables ('\0' separated) */
+    PT_JsonHole pHoles;             /**< value placeholders */
+    int         numHoles;           /**< number of placeholders */
+    int         maxHoles;           /**< number of allocated placeholders */
+    int         cacheable;          /**< set if the rendered response may be cached */
+} T_JsonReadList, *PT_JsonReadList;
+
+/** @brief State of a JSON request */
+typedef struct t_JsonRequest
+{
+    struct mg_connection *conn;     /**< HTTP connection */
+    int cacheable;                  /**< set if the response may be cached */
+    int compilable;                 /**< set if the request may be compiled into a read list */
+    int error;                      /**< set if the response could not be rendered */
+    int members;                    /**< number of members rendered in the response object */
+    int writing;                    /**< set once the write token of the request was taken */
+    int throttled;                  /**< seconds until a write token is available, 0 if not throttled */
+  #if SESSION_EN
+    PT_Session pSession;            /**< session being subscribed, can be NULL */
+    unsigned int sessionId;         /**< id of the session polled, 0 if none */
+    int hasSince;                   /**< set if only changes are polled */
+    unsigned long since;            /**< data-pool generation of the last poll */
+  #endif
+    unsigned long long timeTag;     /**< OSC time tag of the transaction */
+    T_StrBuf transaction;           /**< variable-value pairs of the transaction being parsed */
+    int committing;                 /**< set if a transaction is applied at the end of the request */
+    PT_StrBuf pResponse;            /**< buffer receiving the rendered response */
+    PT_JsonReadList pCompile;       /**< read list compiled from the request, can be NULL */
+    char variable[JPARSE_BUFFER_SIZE]; /**< variable of the write being parsed */
+} T_JsonRequest, *PT_JsonRequest;
+
+#if CGI_CACHE_EN
+
+/** @brief Entry of the JSON request cache, only compiled read requests are cached */
+typedef struct t_JsonCacheEntry
+{
+    unsigned int  hash;             /**< hash of the request */
+    unsigned long lastUsed;         /**< time stamp of the last use (LRU) */
+    T_StrBuf request;               /**< request body */
+    T_JsonReadList readList;        /**< compiled request */
+    int rendered;                   /**< set if the response is valid */
+    unsigned long generation;       /**< data-pool generation of the response */
+    T_StrBuf response;              /**< pre-rendered response */
+} T_JsonCacheEntry, *PT_JsonCacheEntry;
+
+/** JSON request cache */
+static T_JsonCacheEntry cache[CGI_CACHE_ENTRIES];
+
+/** Statistics of the JSON request cache */
+static T_CGI_CacheStats cacheStats;
+
+/** Counter used to find the least recently used cache entry */
+static unsigned long useCounter = 0;
+
+/** Read list compiled from the current request */
+static T_JsonReadList compiling;
+
+/** Copy of the request being compiled, the parser modifies the original */
+static T_StrBuf request;
 
-/** Used by the JSON parser to store a value */
-static char gpValue[JPARSE_BUFFER_SIZE];
+#endif // CGI_CACHE_EN
 
-/** Used by this module to temporary store a variable name */
-static char gpVariable[JPARSE_BUFFER_SIZE];
+#if CGI_STREAM_EN
+
+/** @brief State of a JSON request parsed while it is received */
+typedef struct t_JsonStream
+{
+    T_uJson uJson;                  /**< JSON parser */
+    T_JsonRequest req;              /**< JSON request */
+    T_StrBuf response;              /**< part of the response not sent yet */
+    size_t remaining;               /**< number of bytes of the body not parsed yet */
+    int sending;                    /**< set once a part of the response was sent */
+    int arrayOpen;                  /**< set if the response sent ends inside a "read" or "write" array */
+    const char *pError;             /**< error which stopped the parsing, NULL if none */
+} T_JsonStream, *PT_JsonStream;
+
+#endif // CGI_STREAM_EN
+
+/** Buffer receiving the rendered response, its memory is reused */
+static T_StrBuf response;
 
 /****************************************************************************/
 
 /**
- * @brief Get the next character in the incoming buffer.
- * @param ptr Pointer to JSON parsing structure
- * @return Character
+ * @brief Add a value placeholder at the end of the template of a read list.
+ * @param pList Read list
+ * @param handle Handle of the variable, can be NULL
+ * @param pVariable Variable name
+ * @return 0 on success, -1 if out of memory
  */
-static int getChar(void* ptr)
+static int readListAddHole(PT_JsonReadList pList, DP_HANDLE handle, const char *pVariable)
 {
-    PT_uJson pJson = (PT_uJson)ptr;
-    struct mg_connection *conn = pJson->fp;
-    return conn->content[pJson->readCnt];
+    PT_JsonHole pHole;
+
+    if (pList->numHoles == pList->maxHoles)
+    {
+        int maxHoles = pList->maxHoles ? pList->maxHoles * 2 : 16;
+        pHole = SYS_realloc(pList->pHoles, maxHoles * sizeof(T_JsonHole));
+        if (!pHole)
+            return -1;
+        pList->pHoles = pHole;
+        pList->maxHoles = maxHoles;
+    }
+
+    pHole = &pList->pHoles[pList->numHoles];
+    pHole->offset = pList->templ.len;
+    pHole->handle = handle;
+    pHole->variable = pList->names.len;
+    if (STRBUF_append(&pList->names, pVariable, strlen(pVariable) + 1))
+        return -1;
+    pList->numHoles++;
+    return 0;
+}
+
+/**
+ * @brief Append a part of the response.
+ * @param pReq JSON request
+ * @param pData Data to append
+ * @param len Length of the data
+ */
+static void renderData(PT_JsonRequest pReq, const char *pData, size_t len)
+{
+    if (STRBUF_append(pReq->pResponse, pData, len))
+        pReq->error = 1;
+    if (pReq->pCompile && STRBUF_append(&pReq->pCompile->templ, pData, len))
+        pReq->compilable = 0;
+}
+
+/**
+ * @brief Append a string escaped for a JSON string.
+ * @param pReq JSON request
+ * @param pStr String to append
+ */
+static void renderString(PT_JsonRequest pReq, const char *pStr)
+{
+    size_t len = strlen(pStr);
+
+    if (STRBUF_appendJsonString(pReq->pResponse, pStr, len))
+        pReq->error = 1;
+    if (pReq->pCompile && STRBUF_appendJsonString(&pReq->pCompile->templ, pStr, len))
+        pReq->compilable = 0;
+}
+
+/**
+ * @brief Append a member of the response object.
+ * @param pReq JSON request
+ * @param pMember Member name, quoted and followed by ':'
+ */
+static void renderMember(PT_JsonRequest pReq, const char *pMember)
+{
+    if (pReq->members++)
+        renderData(pReq, ",", 1);
+    renderData(pReq, pMember, strlen(pMember));
+}
+
+/**
+ * @brief Append the value of a variable read.
+ * The value is not part of the template of a compiled read list.
+ * @param pReq JSON request
+ * @param handle Handle of the variable, can be NULL
+ * @param pVariable Variable name
+ * @param pValue Value
+ */
+static void renderValue(PT_JsonRequest pReq, DP_HANDLE handle, const char *pVariable, const char *pValue)
+{
+    if (pReq->pCompile && readListAddHole(pReq->pCompile, handle, pVariable))
+        pReq->compilable = 0;
+
+    if (STRBUF_appendJsonString(pReq->pResponse, pValue, strlen(pValue)))
+        pReq->error = 1;
+}
+
+/**
+ * @brief Append a variable-value pair to the response.
+ * @param pReq JSON request
+ * @param pVariable Variable name
+ * @param pValue Value
+ */
+static void renderPair(PT_JsonRequest pReq, const char *pVariable, const char *pValue)
+{
+    renderData(pReq, "{\"var\":\"", 8);
+    renderString(pReq, pVariable);
+    renderData(pReq, "\",\"val\":\"", 9);
+    renderString(pReq, pValue);
+    renderData(pReq, "\"}", 2);
+}
+
+/**
+ * @brief Apply the writes of a transaction and append them to the response.
+ * The response carries the time tag and the values read back after the
+ * writes, or an error if nothing was written.
+ * @param pReq JSON request
+ */
+static void commitTransaction(PT_JsonRequest pReq)
+{
+    const char *pVariable = pReq->transaction.pData;
+    const char *pEnd = pVariable + pReq->transaction.len;
+    char member[48];
+
+    if (DP_setValues(pVariable, pReq->transaction.len, pReq->timeTag))
+    {
+        renderMember(pReq, "\"error\":\"transaction too large\"");
+        STRBUF_reset(&pReq->transaction);
+        return;
+    }
+
+    sprintf(member, "\"timetag\":\"%016llx\"", pReq->timeTag);
+    renderMember(pReq, member);
+    renderMember(pReq, "\"transaction\":[");
+    while (pVariable && pVariable < pEnd)
+    {
+        if (pVariable != pReq->transaction.pData)
+            renderData(pReq, ",", 1);
+        renderPair(pReq, pVariable, DP_getValue(pVariable));
+        pVariable += strlen(pVariable) + 1;
+        pVariable += strlen(pVariable) + 1;
+    }
+    renderData(pReq, "]", 1);
+    STRBUF_reset(&pReq->transaction);
+}
+
+/****************************************************************************/
+
+/**
+ * @brief Take the write token of a request before its first write.
+ * The route takes a read token, the members writing variables are only
+ * known once their names are decoded. A request writing only counts as
+ * write, so the read token is given back. Without write token the parsing
+ * stops and the request is answered with "429 Too Many Requests".
+ * @param pJson JSON parsing structure
+ * @param pReq JSON request
+ * @return 0 if the request may write, -1 if it is throttled
+ */
+static int takeWriteToken(PT_uJson pJson, PT_JsonRequest pReq)
+{
+  #if RATE_EN
+    int wait;
+
+    if (pReq->writing)
+        return 0;
+    RATE_giveBack(pReq->conn->remote_ip, RATE_READ);
+    wait = RATE_check(pReq->conn->remote_ip, RATE_WRITE, 1);
+    if (wait)
+    {
+        pReq->throttled = wait;
+        pReq->cacheable = 0;
+        pReq->compilable = 0;
+        pJson->eof = 1;
+        return -1;
+    }
+  #endif
+    pReq->writing = 1;
+    return 0;
 }
 
 /**
@@ -58,18 +316,37 @@ static int getChar(void* ptr)
 static void startPair(void* ptr, char* pPair)
 {
     PT_uJson pJson = (PT_uJson)ptr;
+    PT_JsonRequest pReq = (PT_JsonRequest)pJson->pObject;
     if (pJson->objectDepth == 1)
     {
         if (strcmp("read", pPair) == 0)
         {
             pJson->state = 10; // read variable
-            mg_send_data(pJson->fp, "\"read\":", 7);
+            renderMember(pReq, "\"read\":");
         }
         else if (strcmp("write", pPair) == 0)
         {
+            if (takeWriteToken(pJson, pReq))
+                return;
             pJson->state = 20; // write variable
-            mg_send_data(pJson->fp, "\"write\":", 8);
+            renderMember(pReq, "\"write\":");
+        }
+        else if (strcmp("transaction", pPair) == 0)
+        {
+            if (takeWriteToken(pJson, pReq))
+                return;
+            pJson->state = 40; // write variables at once
+            pReq->cacheable = 0;
+            pReq->compilable = 0;
         }
+      #if SESSION_EN
+        else if (strcmp("subscribe", pPair) == 0)
+        {
+            pJson->state = 30; // subscribe to variables
+            pReq->cacheable = 0;
+            pReq->compilable = 0;
+        }
+      #endif
     }
 }
 
@@ -82,6 +359,7 @@ static void startPair(void* ptr, char* pPair)
 static void newValue(void* ptr, char* pPair, char* pValue)
 {
     PT_uJson pJson = (PT_uJson)ptr;
+    PT_JsonRequest pReq = (PT_JsonRequest)pJson->pObject;
     switch (pJson->state)
     {
         case 0:
@@ -90,42 +368,124 @@ static void newValue(void* ptr, char* pPair, char* pValue)
                 // check version
                 if (strcmp("1", pValue) == 0)
                 {
-                    mg_send_data(pJson->fp, "\"version\":\"1\",", 14);
+                    renderMember(pReq, "\"version\":\"1\"");
                 }
                 else
                 {
+                    pReq->cacheable = 0;
+                    pReq->compilable = 0;
                     pJson->eof = 1; // exit parser
                 }
             }
+          #if OSC_EN
+            else if (strcmp("timetag", pPair) == 0)
+            {
+                pReq->timeTag = strtoull(pValue, NULL, 16);
+            }
+            else if (strcmp("delay", pPair) == 0)
+            {
+                pReq->timeTag = OSC_getTimeTag(strtod(pValue, NULL));
+            }
+          #endif
+          #if SESSION_EN
+            else if (strcmp("session", pPair) == 0)
+            {
+                pReq->cacheable = 0;
+                pReq->compilable = 0;
+                pReq->sessionId = (unsigned int)strtoul(pValue, NULL, 16);
+                if (pReq->sessionId == 0)
+                    pReq->sessionId = ~0u; // unknown session
+            }
+            else if (strcmp("since", pPair) == 0)
+            {
+                pReq->cacheable = 0;
+                pReq->compilable = 0;
+                pReq->since = strtoul(pValue, NULL, 10);
+                pReq->hasSince = 1;
+            }
+          #endif
             break;
         case 11: // read first variable
         case 12: // read other variables -> append "," first
             if (strcmp("var", pPair) == 0)
             {
-                const char *val = DP_getValue(pValue);
+                DP_HANDLE handle = DP_getHandle(pValue);
+                const char *val = handle ? DP_getValueByHandle(handle) : DP_getValue(pValue);
+                if (DP_isVolatile(pValue))
+                    pReq->cacheable = 0;
                 if (pJson->state == 12)
-                    mg_send_data(pJson->fp, ",", 1);
+                    renderData(pReq, ",", 1);
                 pJson->state = 12;
-                mg_printf_data(pJson->fp, "{\"var\":\"%s\",\"val\":\"%s\"}", pValue, val);
+                renderData(pReq, "{\"var\":\"", 8);
+                renderString(pReq, pValue);
+                renderData(pReq, "\",\"val\":\"", 9);
+                renderValue(pReq, handle, pValue, val);
+                renderData(pReq, "\"}", 2);
             }
             break;
         case 21: // write first variable
         case 22: // write other variables -> append "," first
+            pReq->cacheable = 0;
+            pReq->compilable = 0;
             if (strcmp("var", pPair) == 0)
             {
-                strncpy(gpVariable, pValue, JPARSE_BUFFER_SIZE - 1);
+                strncpy(pReq->variable, pValue, JPARSE_BUFFER_SIZE - 1);
             }
             else if (strcmp("val", pPair) == 0)
             {
                 const char *val;
-                DP_setValue(gpVariable, pValue);
-                val = DP_getValue(gpVariable);
+                DP_setValue(pReq->variable, pValue);
+                val = DP_getValue(pReq->variable);
                 if (pJson->state == 22)
-                    mg_send_data(pJson->fp, ",", 1);
+                    renderData(pReq, ",", 1);
                 pJson->state = 22;
-                mg_printf_data(pJson->fp, "{\"var\":\"%s\",\"val\":\"%s\"}", gpVariable, val);
+                renderPair(pReq, pReq->variable, val);
             }
             break;
+        case 41: // collect the writes of a transaction
+            if (strcmp("var", pPair) == 0)
+            {
+                strncpy(pReq->variable, pValue, JPARSE_BUFFER_SIZE - 1);
+            }
+            else if (strcmp("val", pPair) == 0)
+            {
+                if (STRBUF_append(&pReq->transaction, pReq->variable, strlen(pReq->variable) + 1) ||
+                    STRBUF_append(&pReq->transaction, pValue, strlen(pValue) + 1))
+                    pReq->error = 1;
+            }
+            break;
+      #if SESSION_EN
+        case 31: // subscribe to a variable or prefix
+            if (pReq->pSession == NULL)
+                break;
+            if (strcmp("var", pPair) == 0)
+            {
+                if (SESSION_addVariable(pReq->pSession, pValue))
+                    pReq->error = 1;
+            }
+            else if (strcmp("prefix", pPair) == 0)
+            {
+                if (SESSION_addPrefix(pReq->pSession, pValue))
+                    pReq->error = 1;
+            }
+            break;
+      #endif
+    }
+}
+
+/**
+ * @brief Callback for "end of object".
+ * @param ptr Pointer to JSON parsing structure
+ */
+static void endObject(void* ptr)
+{
+    PT_uJson pJson = (PT_uJson)ptr;
+    PT_JsonRequest pReq = (PT_JsonRequest)pJson->pObject;
+    if (pJson->objectDepth == 0 && pReq->committing)
+    {
+        if (!pReq->error)
+            commitTransaction(pReq);
+        pReq->committing = 0;
     }
 }
 
@@ -136,12 +496,30 @@ static void newValue(void* ptr, char* pPair, char* pValue)
 static void startArray(void* ptr)
 {
     PT_uJson pJson = (PT_uJson)ptr;
+    PT_JsonRequest pReq = (PT_JsonRequest)pJson->pObject;
     if (pJson->objectDepth == 1)
     {
+      #if SESSION_EN
+        if (pJson->state == 30)
+        {
+            pJson->state++; // --> 31
+            if (pReq->pSession == NULL)
+            {
+                pReq->pSession = SESSION_create();
+                pReq->sessionId = pReq->pSession ? pReq->pSession->id : ~0u;
+            }
+            return;
+        }
+      #endif
+        if (pJson->state == 40)
+        {
+            pJson->state++; // --> 41, rendered when committed
+            return;
+        }
         if (pJson->state > 0)
         {
             pJson->state++; // --> 11 or 21
-            mg_send_data(pJson->fp, "[", 1);
+            renderData(pReq, "[", 1);
         }
     }
 }
@@ -153,40 +531,582 @@ static void startArray(void* ptr)
 static void endArray(void* ptr)
 {
     PT_uJson pJson = (PT_uJson)ptr;
+    PT_JsonRequest pReq = (PT_JsonRequest)pJson->pObject;
     if (pJson->objectDepth == 1)
     {
-        mg_send_data(pJson->fp, "]", 1);
+        switch (pJson->state)
+        {
+            case 31: // subscriptions are not rendered
+                break;
+            case 41: // applied once "timetag" or "delay" after it are parsed
+                pReq->committing = 1;
+                break;
+            default:
+                renderData(pReq, "]", 1);
+                break;
+        }
         pJson->state = 0; // reset state
     }
 }
 
 /****************************************************************************/
 
+#if CGI_CACHE_EN
+
+/**
+ * @brief Empty a read list but keep its memory.
+ * @param pList Read list
+ */
+static void readListReset(PT_JsonReadList pList)
+{
+    STRBUF_reset(&pList->templ);
+    STRBUF_reset(&pList->names);
+    pList->numHoles = 0;
+    pList->cacheable = 0;
+}
+
+/**
+ * @brief Render the response of a compiled read list.
+ * The template is copied with the current values filled in.
+ * @param pReq JSON request
+ * @param pList Read list
+ */
+static void replayReadList(PT_JsonRequest pReq, PT_JsonReadList pList)
+{
+    size_t offset = 0;
+    int i;
+
+    for (i = 0; i < pList->numHoles; i++)
+    {
+        PT_JsonHole pHole = &pList->pHoles[i];
+        const char *pVariable = pList->names.pData + pHole->variable;
+        const char *pValue = pHole->handle ? DP_getValueByHandle(pHole->handle) : DP_getValue(pVariable);
+        renderData(pReq, pList->templ.pData + offset, pHole->offset - offset);
+        renderValue(pReq, pHole->handle, pVariable, pValue);
+        offset = pHole->offset;
+    }
+    renderData(pReq, pList->templ.pData + offset, pList->templ.len - offset);
+    pReq->cacheable = pList->cacheable;
+}
+
+/**
+ * @brief Compute the ETag of a compiled read list.
+ * The tag is made of the versions of the variables, volatile variables
+ * contribute their current value.
+ * @param pList Read list
+ * @param hash Hash of the request
+ * @return Tag
+ */
+static unsigned int readListTag(PT_JsonReadList pList, unsigned int hash)
+{
+    unsigned int tag = hash;
+    int i;
+
+    for (i = 0; i < pList->numHoles; i++)
+    {
+        PT_JsonHole pHole = &pList->pHoles[i];
+        if (pHole->handle)
+        {
+            unsigned long version = DP_getVersion(pHole->handle);
+            tag = str_hashAppend(tag, &version, sizeof(version));
+        }
+        else
+        {
+            const char *pValue = DP_getValue(pList->names.pData + pHole->variable);
+            tag = str_hashAppend(tag, pValue, strlen(pValue) + 1);
+        }
+    }
+    return tag;
+}
+
+/**
+ * @brief Look for a request in the JSON request cache.
+ * @param hash Hash of the request
+ * @param pRequest Request body
+ * @param len Length of the request body
+ * @return Cache entry or NULL if not found
+ */
+static PT_JsonCacheEntry cacheLookup(unsigned int hash, const char *pRequest, size_t len)
+{
+    int i;
+    for (i = 0; i < CGI_CACHE_ENTRIES; i++)
+    {
+        PT_JsonCacheEntry pEntry = &cache[i];
+        if (pEntry->hash == hash && pEntry->request.len == len && pEntry->request.pData &&
+            memcmp(pEntry->request.pData, pRequest, len) == 0)
+        {
+            return pEntry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Replace the least recently used entry of the JSON request cache.
+ * @param hash Hash of the request
+ * @param pRequest Request body
+ * @param len Length of the request body
+ * @return The new cache entry or NULL if out of memory
+ */
+static PT_JsonCacheEntry cacheAdd(unsigned int hash, const char *pRequest, size_t len)
+{
+    PT_JsonCacheEntry pEntry = &cache[0];
+    int i;
+
+    for (i = 1; i < CGI_CACHE_ENTRIES; i++)
+    {
+        if (cache[i].lastUsed < pEntry->lastUsed)
+            pEntry = &cache[i];
+    }
+
+    readListReset(&pEntry->readList);
+    pEntry->rendered = 0;
+    pEntry->hash = 0;
+    STRBUF_reset(&pEntry->request);
+    if (STRBUF_append(&pEntry->request, pRequest, len))
+        return NULL;
+    pEntry->hash = hash;
+    pEntry->lastUsed = ++useCounter;
+    return pEntry;
+}
+
+/**
+ * @brief Store a rendered response in a cache entry.
+ * @param pEntry Cache entry
+ * @param generation Data-pool generation of the response
+ * @param pResponse Rendered response
+ */
+static void cacheStoreResponse(PT_JsonCacheEntry pEntry, unsigned long generation, PT_StrBuf pResponse)
+{
+    STRBUF_reset(&pEntry->response);
+    pEntry->rendered = STRBUF_append(&pEntry->response, pResponse->pData, pResponse->len) == 0;
+    pEntry->generation = generation;
+}
+
+/**
+ * @brief Store a compiled read list in a cache entry.
+ * The buffers are swapped, the old ones are reused for the next compilation.
+ * @param pEntry Cache entry
+ * @param pList Compiled read list
+ */
+static void cacheStoreReadList(PT_JsonCacheEntry pEntry, PT_JsonReadList pList)
+{
+    T_JsonReadList tmp = pEntry->readList;
+    pEntry->readList = *pList;
+    *pList = tmp;
+}
+
+#endif // CGI_CACHE_EN
+
+#if SESSION_EN
+
+/**
+ * @brief Append the variables of the session subscribed to or polled.
+ * If the poll gives the sequence number of a previous response, only the
+ * variables changed since then are rendered. Volatile variables are always
+ * rendered.
+ * @param pReq JSON request
+ */
+static void renderSession(PT_JsonRequest pReq)
+{
+    PT_Session pSession;
+    const char *pVariable;
+    char member[64];
+    int first = 1;
+    int i;
+
+    if (pReq->sessionId == 0)
+        return;
+
+    pSession = SESSION_find(pReq->sessionId);
+    if (!pSession)
+    {
+        renderMember(pReq, "\"error\":\"unknown session\"");
+        return;
+    }
+
+    // new sessions return all values
+    if (pSession == pReq->pSession)
+        pReq->hasSince = 0;
+
+    sprintf(member, "\"session\":\"%08x\"", pSession->id);
+    renderMember(pReq, member);
+    sprintf(member, "\"seq\":\"%lu\"", DP_getGeneration());
+    renderMember(pReq, member);
+    renderMember(pReq, "\"read\":[");
+
+    for (i = 0; i < pSession->numHandles; i++)
+    {
+        DP_HANDLE handle = pSession->pHandles[i];
+        if (pReq->hasSince && DP_getVersion(handle) <= pReq->since)
+            continue;
+        if (!first)
+            renderData(pReq, ",", 1);
+        first = 0;
+        renderPair(pReq, DP_getVariable(handle), DP_getValueByHandle(handle));
+    }
+
+    pVariable = pSession->volatiles.pData;
+    while (pVariable && pVariable < pSession->volatiles.pData + pSession->volatiles.len)
+    {
+        if (!first)
+            renderData(pReq, ",", 1);
+        first = 0;
+        renderPair(pReq, pVariable, DP_getValue(pVariable));
+        pVariable += strlen(pVariable) + 1;
+    }
+    renderData(pReq, "]", 1);
+}
+
+#endif // SESSION_EN
+
+/****************************************************************************/
+
+/**
+ * @brief Render the end of the response.
+ * @param pReq JSON request
+ */
+static void finishResponse(PT_JsonRequest pReq)
+{
+  #if SESSION_EN
+    renderSession(pReq);
+  #endif
+    renderData(pReq, "}", 1);
+
+    // an incomplete transaction is not applied
+    STRBUF_free(&pReq->transaction);
+}
+
+/**
+ * @brief Send the rendered response.
+ * @param pReq JSON request
+ */
+static void sendResponse(PT_JsonRequest pReq)
+{
+    if (pReq->throttled)
+    {
+        ROUTE_sendTooManyRequests(pReq->conn, pReq->throttled);
+    }
+    else if (pReq->error)
+    {
+        mg_send_status(pReq->conn, 500);
+        CGI_sendResponse(pReq->conn, "text/plain", NULL, 0);
+    }
+    else
+    {
+        CGI_sendResponse(pReq->conn, "application/json", pReq->pResponse->pData, pReq->pResponse->len);
+    }
+}
+
+/**
+ * @brief Initialize the JSON parser for a request.
+ * @param pJson JSON parsing structure
+ * @param pReq JSON request
+ */
+static void initParser(PT_uJson pJson, PT_JsonRequest pReq)
+{
+    UJSON_init(pJson);
+    pJson->pObject = pReq;
+    pJson->startPair = startPair;
+    pJson->value = newValue;
+    pJson->startArray = startArray;
+    pJson->endArray = endArray;
+    pJson->endObject = endObject;
+}
+
+/**
+ * @brief Initialize a JSON request.
+ * @param pReq JSON request
+ * @param conn HTTP connection
+ * @param pResponse Buffer receiving the rendered response
+ */
+static void initRequest(PT_JsonRequest pReq, struct mg_connection *conn, PT_StrBuf pResponse)
+{
+    pReq->conn = conn;
+    pReq->cacheable = 1;
+    pReq->compilable = 1;
+    pReq->error = 0;
+    pReq->members = 0;
+    pReq->writing = 0;
+    pReq->throttled = 0;
+  #if SESSION_EN
+    pReq->pSession = NULL;
+    pReq->sessionId = 0;
+    pReq->hasSince = 0;
+    pReq->since = 0;
+  #endif
+    pReq->timeTag = 1; // OSC time tag "immediately"
+    STRBUF_init(&pReq->transaction);
+    pReq->committing = 0;
+    pReq->pResponse = pResponse;
+    pReq->pCompile = NULL;
+    pReq->variable[0] = '\0';
+    pReq->variable[JPARSE_BUFFER_SIZE - 1] = '\0';
+    STRBUF_reset(pResponse);
+}
+
+#if CGI_STREAM_EN
+
+/**
+ * @brief Send the response rendered so far of a streamed JSON request.
+ * @param pStream Streamed JSON request
+ */
+static void streamFlush(PT_JsonStream pStream)
+{
+    if (!pStream->sending)
+    {
+        mg_send_header(pStream->req.conn, "Content-Type", "application/json");
+        pStream->sending = 1;
+    }
+    if (pStream->response.len)
+        mg_send_data(pStream->req.conn, pStream->response.pData, (int)pStream->response.len);
+    STRBUF_reset(&pStream->response);
+    pStream->arrayOpen = (pStream->uJson.state > 10 && pStream->uJson.state < 13) ||
+                         (pStream->uJson.state > 20 && pStream->uJson.state < 23);
+}
+
+/**
+ * @brief Complete the response of a streamed JSON request.
+ * If a part was already sent and the request failed, the response is closed
+ * with an "error" member: "too many requests", "request too large" for a
+ * pair exceeding CGI_STREAM_PAIR_MAX or "invalid request" otherwise.
+ * @param pStream Streamed JSON request
+ */
+static void streamFinish(PT_JsonStream pStream)
+{
+    finishResponse(&pStream->req);
+    if (!pStream->sending)
+    {
+        sendResponse(&pStream->req);
+    }
+    else if (!pStream->req.error && !pStream->req.throttled && !pStream->pError)
+    {
+        // the rest of the chunked response
+        streamFlush(pStream);
+    }
+    else
+    {
+        // the part not sent yet may be incomplete, close the JSON already
+        // sent with an error instead
+        if (pStream->arrayOpen)
+            mg_send_data(pStream->req.conn, "]", 1);
+        if (pStream->req.throttled)
+            pStream->pError = "too many requests";
+        else if (!pStream->pError)
+            pStream->pError = "invalid request";
+        mg_printf_data(pStream->req.conn, ",\"error\":\"%s\"}", pStream->pError);
+    }
+}
+
+/**
+ * @brief Release a streamed JSON request.
+ * @param conn HTTP connection
+ */
+static void streamFree(struct mg_connection *conn)
+{
+    PT_JsonStream pStream = (PT_JsonStream)conn->connection_param;
+    STRBUF_free(&pStream->req.transaction);
+    STRBUF_free(&pStream->response);
+    SYS_free(pStream);
+    conn->connection_param = NULL;
+}
+
+#endif // CGI_STREAM_EN
+
 /**
  */
 void CGI_processJSON(struct mg_connection *conn)
 {
     T_uJson uJson;
+    T_JsonRequest req;
+  #if CGI_CACHE_EN
+    unsigned int hash = 0;
+    unsigned long generation = DP_getGeneration();
+    PT_JsonCacheEntry pEntry;
+  #endif
+
+  #if CGI_STREAM_EN
+    // the request was parsed while it was received
+    if (conn->connection_param)
+    {
+        streamFinish((PT_JsonStream)conn->connection_param);
+        streamFree(conn);
+        return;
+    }
+  #endif
+
+    initRequest(&req, conn, &response);
+
+  #if CGI_CACHE_EN
+    if (conn->content_len <= CGI_CACHE_MAX_SIZE)
+    {
+        hash = str_hash(conn->content, conn->content_len);
+        pEntry = cacheLookup(hash, conn->content, conn->content_len);
+        if (pEntry)
+        {
+            unsigned int tag = readListTag(&pEntry->readList, hash);
+            pEntry->lastUsed = ++useCounter;
+
+            // answer "304 Not Modified" if the client has the current response
+            if (CGI_checkETag(conn, tag))
+            {
+                cacheStats.hits++;
+                return;
+            }
+
+            // send the pre-rendered response if nothing changed
+            if (pEntry->rendered && pEntry->generation == generation)
+            {
+                cacheStats.hits++;
+                CGI_sendETag(conn, tag);
+                CGI_sendResponse(conn, "application/json", pEntry->response.pData, pEntry->response.len);
+                return;
+            }
+            cacheStats.misses++;
+
+            // fill in the current values of the compiled read list, the
+            // headers are sent once it succeeded
+            cacheStats.replays++;
+            replayReadList(&req, &pEntry->readList);
+            if (!req.error)
+            {
+                if (req.cacheable && response.len <= CGI_CACHE_MAX_SIZE)
+                    cacheStoreResponse(pEntry, generation, &response);
+                CGI_sendETag(conn, tag);
+            }
+            sendResponse(&req);
+            return;
+        }
+
+        // compile the request
+        readListReset(&compiling);
+        STRBUF_reset(&request);
+        if (STRBUF_append(&request, conn->content, conn->content_len) == 0)
+            req.pCompile = &compiling;
+    }
+    cacheStats.misses++;
+  #endif
 
     // initialize JSON parser
-    UJSON_init(&uJson);
-    uJson.fp = (void*)conn;
-    uJson.maxReadCnt = conn->content_len;
-    uJson.getChar  = getChar;
-    uJson.startPair = startPair;
-    uJson.value = newValue;
-    uJson.startArray = startArray;
-    uJson.endArray = endArray;
-    uJson.pPair = gpPair;
-    uJson.pairSize = JPARSE_BUFFER_SIZE;
-    uJson.pValue = gpValue;
-    uJson.valueSize = JPARSE_BUFFER_SIZE;
-
-    // set HTTP header for the response
-    mg_send_header(conn, "Content-Type", "application/json");
-
-    // start parsing incoming JSON
-    mg_send_data(conn, "{", 1);
-    UJSON_parse(&uJson);
-    mg_send_data(conn, "}", 1);
+    initParser(&uJson, &req);
+
+    // render the response while parsing the incoming JSON in place
+    renderData(&req, "{", 1);
+    UJSON_parseBuffer(&uJson, conn->content, (long)conn->content_len, 1);
+    finishResponse(&req);
+
+  #if CGI_CACHE_EN
+    // store the compiled request, only read requests are compiled
+    if (req.pCompile && req.compilable && !req.error && compiling.templ.len <= CGI_CACHE_MAX_SIZE)
+    {
+        pEntry = cacheAdd(hash, request.pData, request.len);
+        if (pEntry)
+        {
+            compiling.cacheable = req.cacheable;
+            cacheStoreReadList(pEntry, &compiling);
+
+            // store the response, only reads of non-volatile variables are cached
+            if (req.cacheable && response.len <= CGI_CACHE_MAX_SIZE)
+                cacheStoreResponse(pEntry, generation, &response);
+
+            if (CGI_sendETag(conn, readListTag(&pEntry->readList, hash)))
+                return;
+        }
+    }
+  #endif
+
+    sendResponse(&req);
+}
+
+/**
+ */
+void CGI_getCacheStats(PT_CGI_CacheStats pStats)
+{
+  #if CGI_CACHE_EN
+    *pStats = cacheStats;
+  #else
+    memset(pStats, 0, sizeof(T_CGI_CacheStats));
+  #endif
+}
+
+/**
+ */
+int CGI_recvJSON(struct mg_connection *conn)
+{
+  #if CGI_STREAM_EN
+    PT_JsonStream pStream = (PT_JsonStream)conn->connection_param;
+    long len, n;
+
+    if (!pStream)
+    {
+        const char *pLength = mg_get_header(conn, "Content-Length");
+        size_t length = pLength ? strtoul(pLength, NULL, 10) : 0;
+
+        // small requests are parsed when they are complete
+        if (length < CGI_STREAM_MIN_SIZE)
+            return 0;
+
+        pStream = SYS_malloc(sizeof(T_JsonStream));
+        if (!pStream)
+            return 0;
+        memset(pStream, 0, sizeof(T_JsonStream));
+        initRequest(&pStream->req, conn, &pStream->response);
+        pStream->req.cacheable = 0;
+        pStream->req.compilable = 0;
+        initParser(&pStream->uJson, &pStream->req);
+        pStream->remaining = length;
+        conn->connection_param = pStream;
+        renderData(&pStream->req, "{", 1);
+    }
+
+    // do not consume a pipelined request
+    len = (long)(conn->content_len < pStream->remaining ? conn->content_len : pStream->remaining);
+
+    if (pStream->uJson.eof || pStream->req.error)
+    {
+        // discard the rest of the body
+        n = len;
+    }
+    else
+    {
+        n = UJSON_parseBuffer(&pStream->uJson, conn->content, len, (size_t)len == pStream->remaining);
+        if (n < 0)
+        {
+            // syntax error, stop parsing
+            pStream->uJson.eof = 1;
+            pStream->pError = "invalid request";
+            n = len;
+        }
+        else if (n == 0 && len >= CGI_STREAM_PAIR_MAX)
+        {
+            // pair too large
+            pStream->req.error = 1;
+            pStream->pError = "request too large";
+            n = len;
+        }
+        else if ((size_t)len == pStream->remaining)
+        {
+            n = len;
+        }
+    }
+    pStream->remaining -= n;
+
+    // send the response rendered so far
+    if (!pStream->req.error && pStream->response.len >= CGI_STREAM_FLUSH_SIZE)
+        streamFlush(pStream);
+
+    return (int)n;
+  #else
+    return 0;
+  #endif
+}
+
+/**
+ */
+void CGI_closeJSON(struct mg_connection *conn)
+{
+  #if CGI_STREAM_EN
+    if (conn->connection_param)
+        streamFree(conn);
+  #endif
 }
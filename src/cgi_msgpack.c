@@ -0,0 +1,383 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "cgi.h"
+
+#if CGI_MSGPACK_EN
+
+#include <stdlib.h>
+#include <string.h>
+#include "datapool.h"
+#include "msgpack.h"
+#include "strbuf.h"
+
+#if SESSION_EN
+  #include "session.h"
+#endif
+
+/****************************************************************************/
+
+/** Buffer size for variable names */
+#define MSGPACK_NAME_SIZE           256
+
+/** Content type of requests and responses */
+#define MSGPACK_CONTENT_TYPE        "application/x-msgpack"
+
+/** @brief State of a MessagePack request */
+typedef struct t_MsgPackRequest
+{
+    T_MPack mpack;                  /**< decoder of the request */
+    int members;                    /**< number of members of the response map */
+  #if SESSION_EN
+    PT_Session pSession;            /**< session being subscribed, can be NULL */
+    unsigned int sessionId;         /**< id of the session polled, 0 if none */
+    int hasSince;                   /**< set if only changes are polled */
+    unsigned long since;            /**< data-pool generation of the last poll */
+  #endif
+    char variable[MSGPACK_NAME_SIZE];   /**< variable being processed */
+    char value[DP_VALUE_LENGTH_MAX];    /**< value being written */
+} T_MsgPackRequest, *PT_MsgPackRequest;
+
+/****************************************************************************/
+
+/** Buffer receiving the response, its memory is reused */
+static T_StrBuf response;
+
+/****************************************************************************/
+
+/**
+ * @brief Decode a variable name.
+ * Invalid names are reported as decoding errors.
+ * @param pReq MessagePack request
+ * @return 0 on success, -1 if not a string or too long
+ */
+static int readVariable(PT_MsgPackRequest pReq)
+{
+    T_MPackObject obj;
+
+    if (MPACK_read(&pReq->mpack, &obj) || obj.type != MPACK_STR || obj.len >= MSGPACK_NAME_SIZE)
+    {
+        pReq->mpack.error = 1;
+        return -1;
+    }
+    memcpy(pReq->variable, obj.pData, obj.len);
+    pReq->variable[obj.len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Decode the header of an array or map.
+ * @param pReq MessagePack request
+ * @param type MPACK_ARRAY or MPACK_MAP
+ * @param pCount Number of elements
+ * @return 0 on success, -1 if not of this type
+ */
+static int readContainer(PT_MsgPackRequest pReq, T_MPackType type, uint32_t *pCount)
+{
+    T_MPackObject obj;
+
+    if (MPACK_read(&pReq->mpack, &obj) || obj.type != type)
+    {
+        pReq->mpack.error = 1;
+        return -1;
+    }
+    *pCount = obj.len;
+    return 0;
+}
+
+/**
+ * @brief Append a member name of the response map.
+ * @param pReq MessagePack request
+ * @param pMember Member name
+ * @return 0 on success, -1 if out of memory or too many members
+ */
+static int renderMember(PT_MsgPackRequest pReq, const char *pMember)
+{
+    // the response map has a fixmap header
+    if (++pReq->members > 15)
+    {
+        pReq->mpack.error = 1;
+        return -1;
+    }
+    return MPACK_appendStr(&response, pMember, strlen(pMember));
+}
+
+/**
+ * @brief Process "read": an array of variable names.
+ * The values are returned in an array in the same order.
+ * @param pReq MessagePack request
+ * @return 0 on success, -1 on error
+ */
+static int processRead(PT_MsgPackRequest pReq)
+{
+    uint32_t count, i;
+
+    if (readContainer(pReq, MPACK_ARRAY, &count) ||
+        renderMember(pReq, "read") ||
+        MPACK_appendArray(&response, count))
+        return -1;
+
+    for (i = 0; i < count; i++)
+    {
+        DP_HANDLE handle;
+        const char *pValue;
+
+        if (readVariable(pReq))
+            return -1;
+        handle = DP_getHandle(pReq->variable);
+        pValue = handle ? DP_getValueByHandle(handle) : DP_getValue(pReq->variable);
+        if (MPACK_appendStr(&response, pValue, strlen(pValue)))
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Process "write": a map of variable names and values.
+ * The values stored are returned in an array in the same order.
+ * @param pReq MessagePack request
+ * @return 0 on success, -1 on error
+ */
+static int processWrite(PT_MsgPackRequest pReq)
+{
+    uint32_t count, i;
+
+    if (readContainer(pReq, MPACK_MAP, &count) ||
+        renderMember(pReq, "write") ||
+        MPACK_appendArray(&response, count))
+        return -1;
+
+    for (i = 0; i < count; i++)
+    {
+        T_MPackObject obj;
+        const char *pValue;
+
+        if (readVariable(pReq) || MPACK_read(&pReq->mpack, &obj))
+            return -1;
+        if (MPACK_toString(&obj, pReq->value, sizeof(pReq->value)))
+        {
+            pReq->mpack.error = 1;
+            return -1;
+        }
+        DP_setValue(pReq->variable, pReq->value);
+        pValue = DP_getValue(pReq->variable);
+        if (MPACK_appendStr(&response, pValue, strlen(pValue)))
+            return -1;
+    }
+    return 0;
+}
+
+#if SESSION_EN
+
+/**
+ * @brief Process "subscribe" or "prefix": an array of variable names or prefixes.
+ * @param pReq MessagePack request
+ * @param prefix Set for prefixes
+ * @return 0 on success, -1 on error
+ */
+static int processSubscribe(PT_MsgPackRequest pReq, int prefix)
+{
+    uint32_t count, i;
+
+    if (readContainer(pReq, MPACK_ARRAY, &count))
+        return -1;
+
+    if (pReq->pSession == NULL)
+    {
+        pReq->pSession = SESSION_create();
+        if (!pReq->pSession)
+            return -1;
+        pReq->sessionId = pReq->pSession->id;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (readVariable(pReq))
+            return -1;
+        if (prefix ? SESSION_addPrefix(pReq->pSession, pReq->variable) : SESSION_addVariable(pReq->pSession, pReq->variable))
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Append the variables of the session subscribed to or polled.
+ * The members "session", "seq" and "changed" (a map of variable names and
+ * values) are appended, or "error" if the session is unknown.
+ * @param pReq MessagePack request
+ * @return 0 on success, -1 on error
+ */
+static int renderSession(PT_MsgPackRequest pReq)
+{
+    PT_Session pSession;
+    const char *pVariable;
+    const char *pEnd;
+    uint32_t count = 0;
+    int pass, i;
+
+    if (pReq->sessionId == 0)
+        return 0;
+
+    pSession = SESSION_find(pReq->sessionId);
+    if (!pSession)
+        return renderMember(pReq, "error") || MPACK_appendStr(&response, "unknown session", 15);
+
+    // new sessions return all values
+    if (pSession == pReq->pSession)
+        pReq->hasSince = 0;
+
+    if (renderMember(pReq, "session") || MPACK_appendUint(&response, pSession->id) ||
+        renderMember(pReq, "seq") || MPACK_appendUint(&response, DP_getGeneration()) ||
+        renderMember(pReq, "changed"))
+        return -1;
+
+    // count the changed variables first, the map header needs the count
+    pEnd = pSession->volatiles.pData + pSession->volatiles.len;
+    for (pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1 && MPACK_appendMap(&response, count))
+            return -1;
+
+        for (i = 0; i < pSession->numHandles; i++)
+        {
+            DP_HANDLE handle = pSession->pHandles[i];
+            if (pReq->hasSince && DP_getVersion(handle) <= pReq->since)
+                continue;
+            if (pass == 0)
+            {
+                count++;
+            }
+            else
+            {
+                const char *pValue = DP_getValueByHandle(handle);
+                pVariable = DP_getVariable(handle);
+                if (MPACK_appendStr(&response, pVariable, strlen(pVariable)) ||
+                    MPACK_appendStr(&response, pValue, strlen(pValue)))
+                    return -1;
+            }
+        }
+
+        pVariable = pSession->volatiles.pData;
+        while (pVariable && pVariable < pEnd)
+        {
+            if (pass == 0)
+            {
+                count++;
+            }
+            else
+            {
+                const char *pValue = DP_getValue(pVariable);
+                if (MPACK_appendStr(&response, pVariable, strlen(pVariable)) ||
+                    MPACK_appendStr(&response, pValue, strlen(pValue)))
+                    return -1;
+            }
+            pVariable += strlen(pVariable) + 1;
+        }
+    }
+    return 0;
+}
+
+#endif // SESSION_EN
+
+/**
+ * @brief Process a member of the request map.
+ * Unknown members are skipped.
+ * @param pReq MessagePack request
+ * @return 0 on success, -1 on error
+ */
+static int processMember(PT_MsgPackRequest pReq)
+{
+    T_MPackObject obj;
+
+    if (MPACK_read(&pReq->mpack, &obj) || obj.type != MPACK_STR)
+    {
+        pReq->mpack.error = 1;
+        return -1;
+    }
+
+    if (obj.len == 4 && memcmp(obj.pData, "read", 4) == 0)
+        return processRead(pReq);
+    if (obj.len == 5 && memcmp(obj.pData, "write", 5) == 0)
+        return processWrite(pReq);
+  #if SESSION_EN
+    if (obj.len == 9 && memcmp(obj.pData, "subscribe", 9) == 0)
+        return processSubscribe(pReq, 0);
+    if (obj.len == 6 && memcmp(obj.pData, "prefix", 6) == 0)
+        return processSubscribe(pReq, 1);
+    if (obj.len == 7 && memcmp(obj.pData, "session", 7) == 0)
+    {
+        if (MPACK_read(&pReq->mpack, &obj) || obj.type != MPACK_UINT)
+        {
+            pReq->mpack.error = 1;
+            return -1;
+        }
+        pReq->sessionId = (unsigned int)obj.v.u;
+        if (pReq->sessionId == 0 || pReq->sessionId != obj.v.u)
+            pReq->sessionId = ~0u; // unknown session
+        return 0;
+    }
+    if (obj.len == 5 && memcmp(obj.pData, "since", 5) == 0)
+    {
+        if (MPACK_read(&pReq->mpack, &obj) || obj.type != MPACK_UINT)
+        {
+            pReq->mpack.error = 1;
+            return -1;
+        }
+        pReq->since = (unsigned long)obj.v.u;
+        pReq->hasSince = 1;
+        return 0;
+    }
+  #endif
+    return MPACK_skip(&pReq->mpack);
+}
+
+/****************************************************************************/
+
+/**
+ */
+void CGI_processMsgPack(struct mg_connection *conn)
+{
+    T_MsgPackRequest req;
+    uint32_t count, i;
+    int ret;
+
+    memset(&req, 0, sizeof(req));
+    MPACK_init(&req.mpack, conn->content, conn->content_len);
+
+    // the fixmap header of the response is written at the end
+    STRBUF_reset(&response);
+    ret = STRBUF_append(&response, "\x80", 1);
+
+    ret = ret || readContainer(&req, MPACK_MAP, &count);
+    for (i = 0; !ret && i < count; i++)
+        ret = processMember(&req);
+  #if SESSION_EN
+    ret = ret || renderSession(&req);
+  #endif
+
+    if (ret)
+    {
+        mg_send_status(conn, req.mpack.error ? 400 : 500);
+        CGI_sendResponse(conn, "text/plain", NULL, 0);
+        return;
+    }
+
+    response.pData[0] = (char)(0x80 | req.members);
+    CGI_sendResponse(conn, MSGPACK_CONTENT_TYPE, response.pData, response.len);
+}
+
+#endif // CGI_MSGPACK_EN
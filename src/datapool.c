@@ -25,6 +25,11 @@
 
 #if OSC_EN
   #include "osc.h"
+  #include "osc_route.h"
+#endif
+
+#if PUSH_EN
+  #include "push.h"
 #endif
 
 /****************************************************************************/
@@ -34,6 +39,7 @@ typedef struct t_DataPoolEntry
 {
     char *pVariable;                /**< pointer to the variable */
     char *pValue;                   /**< pointer to the value */
+    unsigned long version;          /**< data-pool generation of the last write */
     struct t_DataPoolEntry *pNext;  /**< pointer to the next list entry */
 } T_DataPoolEntry, *PT_DataPoolEntry;
 
@@ -48,6 +54,12 @@ static PT_DataPoolEntry pDataPool = NULL;
 /** Specify if new variables should be added on the fly if not found */
 static int allocOnTheFly = 0;
 
+/** Generation counter, incremented on every write */
+static unsigned long generation = 0;
+
+/** Number of entries in the data-pool */
+static unsigned long count = 0;
+
 /****************************************************************************/
 
 /**
@@ -74,6 +86,7 @@ static PT_DataPoolEntry addEntry(const char *pVariable, const char *pValue)
     if (pNext)
     {
         pNext->pNext = NULL;
+        pNext->version = generation;
         pNext->pVariable = SYS_malloc(strlen(pVariable) + 1);
         if (pNext->pVariable)
         {
@@ -86,6 +99,7 @@ static PT_DataPoolEntry addEntry(const char *pVariable, const char *pValue)
                     pParent->pNext = pNext;
                 else
                     pDataPool = pNext;
+                count++;
                 return pNext;
             }
         }
@@ -101,12 +115,16 @@ static PT_DataPoolEntry addEntry(const char *pVariable, const char *pValue)
  */
 static int callback_initFromFile(char *pParameter, char* pValue)
 {
+  #if OSC_EN
+    const T_OSCROUTE_Destination *pDestination = OSCROUTE_find(pParameter);
+  #endif
+
     addEntry(pParameter, pValue);
   #if OSC_EN
-    if (strncmp(app.osc_prefix, pParameter, strlen(app.osc_prefix)) == 0)
+    if (pDestination)
     {
         T_OSC_ArgType arg = OSC_getArgType(pValue);
-        OSC_appendMessage(pParameter, 1, &arg);
+        OSC_queueMessage(pDestination->host, pDestination->port, pParameter, &arg);
     }
   #endif
     return 1;
@@ -127,15 +145,11 @@ int DP_init(const char *pFileName, int onTheFlyAllocation)
     // initialize variables from a file
     if (pFileName)
     {
-
-      #if OSC_EN
-        OSC_initMessages(1);
-      #endif
-
         ret = getConfigFromFile(pFileName, "["CONFIG_SECTION_DATAPOOL"]", callback_initFromFile);
 
       #if OSC_EN
-        OSC_sendMessages(app.osc_host, app.osc_port);
+        // send the initial values to the OSC hosts
+        OSC_flush(1);
       #endif
     }
 
@@ -183,6 +197,8 @@ void DP_deinit(void)
         SYS_free(pDel->pVariable);
         SYS_free(pDel);
     }
+    pDataPool = NULL;
+    count = 0;
 }
 
 /**
@@ -242,8 +258,12 @@ const char* DP_getValue(const char *pVariable)
 }
 
 /**
+ * @brief Write a value to the data-pool.
+ * @param pVariable Variable name
+ * @param pValue New value
+ * @param route Set to route the new value to the OSC host
  */
-void DP_setValue(const char *pVariable, const char *pValue)
+static void setValue(const char *pVariable, const char *pValue, int route)
 {
     PT_DataPoolEntry pData = pDataPool;
 
@@ -251,6 +271,9 @@ void DP_setValue(const char *pVariable, const char *pValue)
     if (!initialized)
         return;
 
+    // invalidate everything computed from older values
+    generation++;
+
     // look for entry in system data-pool
     if (DPSYSTEM_setValue(pVariable, pValue))
     {
@@ -260,6 +283,9 @@ void DP_setValue(const char *pVariable, const char *pValue)
     {
         // look for entry in user data-pool
         DPUSER_setValue(pVariable, pValue);
+      #if PUSH_EN
+        PUSH_notify(pVariable, pValue);
+      #endif
     }
     else
     {
@@ -270,6 +296,7 @@ void DP_setValue(const char *pVariable, const char *pValue)
             {
                 // update value
                 strncpy(pData->pValue, pValue, DP_VALUE_LENGTH_MAX - 1);
+                pData->version = generation;
                 break;
             }
             pData = pData->pNext;
@@ -280,16 +307,195 @@ void DP_setValue(const char *pVariable, const char *pValue)
         {
             pData = addEntry(pVariable, pValue);
         }
+
+      #if PUSH_EN
+        // propagate new value to subscribed web clients
+        if (pData)
+            PUSH_notify(pVariable, pData->pValue);
+      #endif
     }
 
   #if OSC_EN
-    // route new value to OSC host
-    if (strncmp(app.osc_prefix, pVariable, strlen(app.osc_prefix)) == 0)
+    // route new value to its OSC host
+    if (route)
     {
-        T_OSC_ArgType arg = OSC_getArgType(pValue);
-        OSC_initMessages(0);
-        OSC_appendMessage(pVariable, 1, &arg);
-        OSC_sendMessages(app.osc_host, app.osc_port);
+        const T_OSCROUTE_Destination *pDestination = OSCROUTE_find(pVariable);
+        if (pDestination)
+        {
+            T_OSC_ArgType arg = OSC_getArgType(pValue);
+            OSC_queueMessage(pDestination->host, pDestination->port, pVariable, &arg);
+        }
+    }
+  #endif
+}
+
+/**
+ */
+void DP_setValue(const char *pVariable, const char *pValue)
+{
+    setValue(pVariable, pValue, 1);
+}
+
+#if OSC_EN
+
+/**
+ * @brief Build the bundle of the variables of a transaction routed to one OSC host.
+ * @param pPairs Variable names and values (see DP_setValues())
+ * @param len Length of the pairs
+ * @param timeTag Time tag of the bundle
+ * @param pDestination OSC host
+ * @return Number of messages in the bundle, -1 if the bundle is too large
+ */
+static int buildBundle(const char *pPairs, size_t len, unsigned long long timeTag, const T_OSCROUTE_Destination *pDestination)
+{
+    const char *pEnd = pPairs + len;
+    const char *pVariable;
+    const char *pValue;
+    int count = 0;
+
+    if (OSC_initBundle(timeTag))
+        return -1;
+    for (pVariable = pPairs; pVariable < pEnd; pVariable = pValue + strlen(pValue) + 1)
+    {
+        pValue = pVariable + strlen(pVariable) + 1;
+        if (OSCROUTE_find(pVariable) == pDestination)
+        {
+            T_OSC_ArgType arg = OSC_getArgType(pValue);
+            if (OSC_appendMessage(pVariable, 1, &arg))
+                return -1;
+            count++;
+        }
+    }
+    return count;
+}
+
+#endif // OSC_EN
+
+/**
+ */
+int DP_setValues(const char *pPairs, size_t len, unsigned long long timeTag)
+{
+    const char *pEnd = pPairs + len;
+    const char *pVariable;
+    const char *pValue;
+  #if OSC_EN
+    const T_OSCROUTE_Destination *pDestination;
+    int i;
+  #endif
+
+    // check if initialized
+    if (!initialized)
+        return 0;
+
+  #if OSC_EN
+    // build the bundles first, nothing is written if one does not fit
+    for (i = 0; (pDestination = OSCROUTE_get(i)) != NULL; i++)
+    {
+        if (buildBundle(pPairs, len, timeTag, pDestination) < 0)
+            return -1;
+    }
+  #else
+    (void)timeTag;
+  #endif
+
+    for (pVariable = pPairs; pVariable < pEnd; pVariable = pValue + strlen(pValue) + 1)
+    {
+        pValue = pVariable + strlen(pVariable) + 1;
+        setValue(pVariable, pValue, 0);
+    }
+
+  #if OSC_EN
+    // route the new values to the OSC hosts, one bundle per host
+    for (i = 0; (pDestination = OSCROUTE_get(i)) != NULL; i++)
+    {
+        if (buildBundle(pPairs, len, timeTag, pDestination) > 0)
+            OSC_sendMessages(pDestination->host, pDestination->port);
     }
   #endif
+    return 0;
+}
+
+/**
+ */
+void DP_updateValue(const char *pVariable, const char *pValue)
+{
+    setValue(pVariable, pValue, 0);
+}
+
+/**
+ */
+DP_HANDLE DP_getHandle(const char *pVariable)
+{
+    PT_DataPoolEntry pData = pDataPool;
+
+    // check if initialized
+    if (!initialized || DP_isVolatile(pVariable))
+        return NULL;
+
+    // look for entry in data-pool
+    while (pData)
+    {
+        if (strcmp(pData->pVariable, pVariable) == 0)
+            return pData;
+        pData = pData->pNext;
+    }
+
+    // add new entry
+    if (allocOnTheFly)
+        return addEntry(pVariable, "");
+
+    return NULL;
+}
+
+/**
+ */
+const char* DP_getValueByHandle(DP_HANDLE handle)
+{
+    return handle->pValue;
+}
+
+/**
+ */
+unsigned long DP_getVersion(DP_HANDLE handle)
+{
+    return handle->version;
+}
+
+/**
+ */
+DP_HANDLE DP_getNext(DP_HANDLE handle)
+{
+    if (!initialized)
+        return NULL;
+    return handle ? handle->pNext : pDataPool;
+}
+
+/**
+ */
+const char* DP_getVariable(DP_HANDLE handle)
+{
+    return handle->pVariable;
+}
+
+/**
+ */
+unsigned long DP_getCount(void)
+{
+    return count;
+}
+
+/**
+ */
+unsigned long DP_getGeneration(void)
+{
+    return generation;
+}
+
+/**
+ */
+int DP_isVolatile(const char *pVariable)
+{
+    if (DPSYSTEM_isSystem(pVariable))
+        return 1;
+    return strncmp(app.user_prefix, pVariable, strlen(app.user_prefix)) == 0;
 }
@@ -28,6 +28,7 @@
 #ifndef _DATAPOOL_H_
 #define _DATAPOOL_H_
 
+#include <stddef.h>
 #include "release.h"
 
 /**
@@ -47,9 +48,15 @@
  *
  * Additionally if OSC_EN is enabled, every time a variable starting with
  * the prefix OSC_PREFIX is written to, this new value is propagated via OSC.
+ *
+ * If PUSH_EN is enabled, every new value is also pushed to the web clients
+ * subscribed to data-pool changes (see PUSH).
  * @{
  */
  
+/** @brief Handle of a variable stored in the data-pool (opaque) */
+typedef struct t_DataPoolEntry *DP_HANDLE;
+
 /** Maximal length of a value */
 #ifndef DP_VALUE_LENGTH_MAX
   #define DP_VALUE_LENGTH_MAX           256
@@ -89,6 +96,92 @@ const char* DP_getValue(const char *pVariable);
  */
 void DP_setValue(const char *pVariable, const char *pValue);
 
+/**
+ * @brief Set several values at once (transaction).
+ * The values are written one after the other without returning to the
+ * web-server in between, so no request sees a part of them only. The values
+ * routed to the OSC host are sent in one bundle with the given time tag.
+ * Nothing is written if these values do not fit in one bundle.
+ * @param pPairs Variable-value pairs, each string terminated by '\0'
+ * @param len Length of the pairs in bytes
+ * @param timeTag OSC time tag of the bundle (see OSC_initBundle())
+ * @return 0 on success, -1 if the bundle is too large
+ */
+int DP_setValues(const char *pPairs, size_t len, unsigned long long timeTag);
+
+/**
+ * @brief Set a new value without routing it to the OSC host.
+ * Use this function for values which already reached the OSC host, web
+ * clients are still notified.
+ * @param pVariable Variable name
+ * @param pValue New value
+ */
+void DP_updateValue(const char *pVariable, const char *pValue);
+
+/**
+ * @brief Get the handle of a variable.
+ * A handle allows to access a variable without looking it up by name.
+ * Handles stay valid until DP_deinit() is called.
+ * @note Volatile variables (see DP_isVolatile()) have no handle.
+ * @param pVariable Variable name
+ * @return Handle of the variable or NULL if not found or volatile
+ */
+DP_HANDLE DP_getHandle(const char *pVariable);
+
+/**
+ * @brief Get the value of a variable by its handle.
+ * @param handle Handle of the variable (see DP_getHandle())
+ * @return Value of the variable
+ */
+const char* DP_getValueByHandle(DP_HANDLE handle);
+
+/**
+ * @brief Get the version of a variable.
+ * The version is the data-pool generation of the last write to the variable.
+ * @param handle Handle of the variable (see DP_getHandle())
+ * @return Version of the variable
+ */
+unsigned long DP_getVersion(DP_HANDLE handle);
+
+/**
+ * @brief Iterate over the variables of the data-pool.
+ * Only variables with a handle are returned, not the volatile ones.
+ * @param handle Current variable, NULL to get the first one
+ * @return Handle of the next variable or NULL at the end of the data-pool
+ */
+DP_HANDLE DP_getNext(DP_HANDLE handle);
+
+/**
+ * @brief Get the name of a variable by its handle.
+ * @param handle Handle of the variable (see DP_getHandle())
+ * @return Variable name
+ */
+const char* DP_getVariable(DP_HANDLE handle);
+
+/**
+ * @brief Get the number of variables with a handle.
+ * The number only grows, variables are never removed before DP_deinit().
+ * @return Number of variables
+ */
+unsigned long DP_getCount(void);
+
+/**
+ * @brief Get the generation counter of the data-pool.
+ * The counter is incremented every time a value is written, so two equal
+ * generations guarantee that no value of the data-pool has changed.
+ * @note System and user variables may change without a write, see DP_isVolatile().
+ * @return Generation counter
+ */
+unsigned long DP_getGeneration(void);
+
+/**
+ * @brief Check if a variable may change without being written to.
+ * This is the case for system and user variables.
+ * @param pVariable Variable name
+ * @return 1 if the variable is volatile
+ */
+int DP_isVolatile(const char *pVariable);
+
 
 /**
  * @defgroup DATAPOOL_SYSTEM System Data-pool
@@ -104,6 +197,10 @@ void DP_setValue(const char *pVariable, const char *pValue);
  * - OSC_HOST: host name of OSC host (read-only)
  * - OSC_PORT: port of OSC host (read-only)
  * - OSC_PREFIX: prefix of variables routed to the OSC host (read-only)
+ * - CACHE_HITS: number of JSON requests answered from the response cache (read-only)
+ * - CACHE_MISSES: number of JSON requests not found in the response cache (read-only)
+ * - CACHE_REPLAYS: number of cache misses answered from a compiled read list (read-only)
+ * - SESSIONS: number of active read subscriptions of json.cgi (read-only)
  * @{
  */
  
@@ -142,6 +239,13 @@ const char* DPSYSTEM_getValue(const char *pVariable);
  */
 int DPSYSTEM_setValue(const char *pVariable, const char *pValue);
 
+/**
+ * @brief Check if a variable is a system variable.
+ * @param pVariable Variable name
+ * @return 1 if variable is a system variable
+ */
+int DPSYSTEM_isSystem(const char *pVariable);
+
 /** @} DATAPOOL_SYSTEM */
 
 
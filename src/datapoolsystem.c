@@ -21,6 +21,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include "datapool.h"
+#include "cgi.h"
+
+#if SESSION_EN
+  #include "session.h"
+#endif
+
+#if OSC_EN
+  #include "osc.h"
+#endif
+#if OSCIN_EN
+  #include "osc_input.h"
+#endif
+#if OSC_TCP_EN
+  #include "osc_tcp.h"
+#endif
 
 #if defined(LINUX)
   #include <unistd.h>
@@ -36,6 +51,25 @@
 static const char* getServerIpAddress(void);
 static const char* getServerPort(void);
 static const char* getOSCPort(void);
+static const char* getCacheHits(void);
+static const char* getCacheMisses(void);
+static const char* getCacheReplays(void);
+#if SESSION_EN
+static const char* getSessions(void);
+#endif
+#if OSC_EN
+static const char* getOSCSent(void);
+static const char* getOSCDropped(void);
+static const char* getOSCSyscalls(void);
+static const char* getOSCLatency(void);
+#endif
+#if OSCIN_EN
+static const char* getOSCReceived(void);
+static const char* getOSCForwarded(void);
+#endif
+#if OSC_TCP_EN
+static const char* getOSCTcp(void);
+#endif
 
 /****************************************************************************/
 
@@ -61,6 +95,25 @@ static const SystemData_type systemData[] =
     { "OSC_HOST", app.osc_host, NULL, NULL },
     { "OSC_PORT", NULL, getOSCPort, NULL },
     { "OSC_PREFIX", app.osc_prefix, NULL, NULL },
+    { "CACHE_HITS", NULL, getCacheHits, NULL },
+    { "CACHE_MISSES", NULL, getCacheMisses, NULL },
+    { "CACHE_REPLAYS", NULL, getCacheReplays, NULL },
+  #if SESSION_EN
+    { "SESSIONS", NULL, getSessions, NULL },
+  #endif
+  #if OSC_EN
+    { "OSC_SENT", NULL, getOSCSent, NULL },
+    { "OSC_DROPPED", NULL, getOSCDropped, NULL },
+    { "OSC_SYSCALLS", NULL, getOSCSyscalls, NULL },
+    { "OSC_LATENCY", NULL, getOSCLatency, NULL },
+  #endif
+  #if OSCIN_EN
+    { "OSC_RECEIVED", NULL, getOSCReceived, NULL },
+    { "OSC_FORWARDED", NULL, getOSCForwarded, NULL },
+  #endif
+  #if OSC_TCP_EN
+    { "OSC_TCP", NULL, getOSCTcp, NULL },
+  #endif
     { NULL, NULL, NULL, NULL }
 };
 
@@ -124,6 +177,20 @@ int DPSYSTEM_setValue(const char *pVariable, const char *pValue)
     return 0;
 }
 
+/**
+ */
+int DPSYSTEM_isSystem(const char *pVariable)
+{
+    const SystemData_type *ptr = systemData;
+    while (ptr->pVariable)
+    {
+        if (strcmp(ptr->pVariable, pVariable) == 0)
+            return 1;
+        ++ptr;
+    }
+    return 0;
+}
+
 /****************************************************************************/
 
 /**
@@ -174,3 +241,151 @@ static const char* getOSCPort(void)
     sprintf(port, "%d", app.osc_port);
     return port;
 }
+
+/**
+ */
+static const char* getCacheHits(void)
+{
+    static char hits[16];
+    T_CGI_CacheStats stats;
+    CGI_getCacheStats(&stats);
+    sprintf(hits, "%lu", stats.hits);
+    return hits;
+}
+
+/**
+ */
+static const char* getCacheMisses(void)
+{
+    static char misses[16];
+    T_CGI_CacheStats stats;
+    CGI_getCacheStats(&stats);
+    sprintf(misses, "%lu", stats.misses);
+    return misses;
+}
+
+/**
+ */
+static const char* getCacheReplays(void)
+{
+    static char replays[16];
+    T_CGI_CacheStats stats;
+    CGI_getCacheStats(&stats);
+    sprintf(replays, "%lu", stats.replays);
+    return replays;
+}
+
+#if SESSION_EN
+
+/**
+ */
+static const char* getSessions(void)
+{
+    static char sessions[16];
+    sprintf(sessions, "%d", SESSION_getCount());
+    return sessions;
+}
+
+#endif
+
+#if OSC_EN
+
+/**
+ */
+static const char* getOSCSent(void)
+{
+    static char sent[24];
+    T_OSC_Stats stats;
+    OSC_getStats(&stats);
+    sprintf(sent, "%lu", stats.sent);
+    return sent;
+}
+
+/**
+ */
+static const char* getOSCDropped(void)
+{
+    static char dropped[24];
+    T_OSC_Stats stats;
+    OSC_getStats(&stats);
+    sprintf(dropped, "%lu", stats.dropped);
+    return dropped;
+}
+
+/**
+ */
+static const char* getOSCSyscalls(void)
+{
+    static char syscalls[24];
+    T_OSC_Stats stats;
+    OSC_getStats(&stats);
+    sprintf(syscalls, "%lu", stats.syscalls);
+    return syscalls;
+}
+
+/**
+ * @brief Get the average and longest time from queuing to sending of the
+ * OSC packets in microseconds, e.g. "12/85".
+ * @return Latency
+ */
+static const char* getOSCLatency(void)
+{
+    static char latency[48];
+    T_OSC_Stats stats;
+    OSC_getStats(&stats);
+    sprintf(latency, "%llu/%llu", stats.sent + stats.failed ? stats.totalLatencyUs / (stats.sent + stats.failed) : 0ULL, stats.maxLatencyUs);
+    return latency;
+}
+
+#endif
+
+#if OSCIN_EN
+
+/**
+ * @brief Get the number of messages received from the OSC host and written
+ * to the data-pool.
+ * @return Number of messages
+ */
+static const char* getOSCReceived(void)
+{
+    static char received[24];
+    T_OSCIN_Stats stats;
+    OSCIN_getStats(&stats);
+    sprintf(received, "%lu", stats.messages);
+    return received;
+}
+
+/**
+ * @brief Get the number of messages received from controllers and written
+ * to the data-pool.
+ * @return Number of messages
+ */
+static const char* getOSCForwarded(void)
+{
+    static char forwarded[24];
+    T_OSCIN_Stats stats;
+    OSCIN_getStats(&stats);
+    sprintf(forwarded, "%lu", stats.forwarded);
+    return forwarded;
+}
+
+#endif
+
+#if OSC_TCP_EN
+
+/**
+ * @brief Get the number of packets sent to the OSC hosts reached over TCP,
+ * of queued messages replaced by a newer value and of dropped packets,
+ * e.g. "1200/35/0".
+ * @return Statistics
+ */
+static const char* getOSCTcp(void)
+{
+    static char tcp[72];
+    T_OSCTCP_Stats stats;
+    OSCTCP_getStats(&stats);
+    sprintf(tcp, "%lu/%lu/%lu", stats.sent, stats.coalesced, stats.dropped);
+    return tcp;
+}
+
+#endif
@@ -20,12 +20,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "mongoose.h"
 #include "datapool.h"
+#include "route.h"
 
 // example variables
 static int myIntVar = 0;
 static char myStrVar[DP_VALUE_LENGTH_MAX];
 
+/**
+ * @brief Example endpoint returning the string variable as plain text.
+ * @param conn HTTP request information
+ * @return MG_TRUE when the request is processed
+ */
+static int processUserRequest(struct mg_connection *conn)
+{
+    mg_send_header(conn, "Content-Type", "text/plain");
+    mg_printf_data(conn, "%s", myStrVar);
+    return MG_TRUE;
+}
+
+// example endpoint route
+static const T_Route myRoute = { ROUTE_CGI_PATH "user.cgi", ROUTE_GET, ROUTE_LIMIT_READ, processUserRequest, NULL, NULL, NULL };
+
 /**
  */
 void DPUSER_init(void)
@@ -33,6 +50,9 @@ void DPUSER_init(void)
     // add your initialization code here
     myIntVar = 0;
     strncpy(myStrVar, "String variable", DP_VALUE_LENGTH_MAX);
+
+    // register your endpoints here
+    ROUTE_register(&myRoute);
 }
 
 /**
@@ -150,6 +150,33 @@
  * - <b> jQuery:</b> http://jquery.com/
  *
  * @section ReleaseNotes Release Notes
+ * <b>[v1.2.0]</b>
+ * - [new] Data-pool changes can be pushed to web clients (push.cgi), benchmark with many subscribers examples/OSC-push-bench.
+ * - [new] Cache for JSON read responses (CACHE_HITS and CACHE_MISSES system variables).
+ * - JSON read requests are compiled once into response templates with data-pool handles (CACHE_REPLAYS)
+ * - ETag / If-None-Match (304 Not Modified) on json.cgi and getValue.cgi read responses
+ * - json.cgi renders into one pooled buffer and replies with Content-Length instead of per-fragment chunks
+ * - Zero-copy reentrant JSON parser (UJSON_parseBuffer) used by json.cgi, UJSON_parse kept as a wrapper
+ * - JSON parser finds string ends with memchr(), "make SIMD=1" scans strings, white spaces and values in 16-byte SSE2 or NEON blocks
+ * - Large json.cgi requests are parsed and applied while they are received (CGI_STREAM_EN)
+ * - JSON responses escape quotes, backslashes and control characters, incoming escape sequences are decoded
+ * - json.cgi read subscriptions: register variables and prefixes once, poll changes by session id (SESSION_EN)
+ * - [new] MessagePack endpoint msgpack.cgi for reads, writes and subscriptions (CGI_MSGPACK_EN), used by OSCC_getValues()/OSCC_setValues() of examples/OSC-webgate-client, compared with json.cgi by OSC-webgate-client-bench
+ * - [new] osc.cgi forwards raw OSC messages and bundles to the OSC host and updates the data-pool
+ * - [new] Route table (radix trie) with method filters and per-route statistics (routes.cgi)
+ * - [new] Per-client rate limits for read and write requests (RATE_EN, limit_* in OSC-webgate.conf)
+ * - [new] json.cgi transactions: writes applied at once and sent as one OSC bundle with a time tag
+ * - OSC packets are sent through persistent connected UDP sockets, host names are resolved with getaddrinfo (IPv6) and refreshed periodically
+ * - [new] OSC output coalescing: values are collected for osc_window ms, deduplicated by address and sent as bundles
+ * - [new] OSC packets are sent by a dedicated thread fed by a lock-free ring (OSC_THREAD_EN), system variables OSC_SENT, OSC_DROPPED, OSC_LATENCY
+ * - [new] OSC packets queued to the sender thread are sent in batches with sendmmsg() (OSC_SENDMMSG_EN, OSC_BATCH_SIZE), system variable OSC_SYSCALLS
+ * - [new] OSC input: messages sent back by the OSC host to osc_listen_port update the data-pool and the web clients (OSCIN_EN), system variable OSC_RECEIVED
+ * - [new] OSC hub: messages of controllers sent to osc_hub_port update the data-pool and are forwarded to the OSC host through the output coalescer, system variable OSC_FORWARDED
+ * - [new] OSC routing table: osc_route lines map prefixes to further OSC hosts, longest prefix match in a radix trie, one socket and separate bundles per host
+ * - [new] OSC multicast and broadcast destinations, settings osc_multicast_ttl and osc_multicast_if
+ * - [new] OSC over TCP with SLIP framing for hosts named tcp://host (OSC_TCP_EN): non-blocking connection with automatic reconnect, bounded queue keeping the latest value per address, system variable OSC_TCP, test host examples/OSC-tcp-sink
+ * - [new] OSC 1.1 argument types int64, double, blob, true/false, nil and time tag: written with the explicit forms #h, #d, #t, #b, #T, #F and #N, decoded from the OSC host and controllers
+ *
  * <b>[v1.1.0]</b>
  * - [fix] System (pre-defined) data-pool is now checked before user data-pool.
  *
@@ -174,6 +201,27 @@
 #include "mongoose.h"
 #include "datapool.h"
 #include "cgi.h"
+#include "route.h"
+#if RATE_EN
+  #include "ratelimit.h"
+#endif
+#if OSC_EN
+  #include "osc.h"
+  #include "osc_route.h"
+#endif
+#if OSCIN_EN
+  #include "osc_input.h"
+#endif
+#if OSC_TCP_EN
+  #include "osc_tcp.h"
+#endif
+#if PUSH_EN
+  #include "push.h"
+#endif
+
+#if SESSION_EN
+  #include "session.h"
+#endif
 
 /****************************************************************************/
 
@@ -196,32 +244,7 @@ struct mg_server *webserver = NULL;
  */
 static int event_handler(struct mg_connection *conn, enum mg_event ev)
 {
-    if (ev == MG_REQUEST)
-    {
-        if (strncmp(conn->uri, "/cgi-bin/", 9) == 0)
-        {
-            if (strcmp(conn->uri+9, "json.cgi") == 0)
-            {
-                CGI_processJSON(conn);
-            }
-            else if (strcmp(conn->uri + 9, "getValue.cgi") == 0)
-            {
-                CGI_processGetValue(conn);
-            }
-            else if (strcmp(conn->uri + 9, "setValue.cgi") == 0)
-            {
-                CGI_processSetValue(conn);
-            }
-            else
-            {
-                // send forbidden status code
-                mg_send_status(conn, 403);
-                mg_send_data(conn, "", 0);
-            }
-            return MG_TRUE;
-        }
-    }
-    return MG_FALSE;
+    return ROUTE_handleEvent(conn, ev);
 }
 
 /**
@@ -235,12 +258,48 @@ static void closeAll(void)
         return;
     closed = 1;
 
+  #if OSC_EN
+    // send the collected messages while the web-server still runs the TCP connections
+    OSC_flush(1);
+   #if OSC_TCP_EN
+    if (webserver)
+        mg_poll_server(webserver, 0);
+    OSCTCP_deinit();
+   #endif
+  #endif
+
     // de-initialize web-server
     mg_destroy_server(&webserver);
 
+  #if SESSION_EN
+    // release the sessions, their handles become invalid with the data-pool
+    SESSION_deinit();
+  #endif
+
     // de-initialize data-pool
     DP_deinit();
 
+  #if PUSH_EN
+    // de-initialize push module
+    PUSH_deinit();
+  #endif
+
+    // remove all routes
+    ROUTE_deinit();
+
+  #if RATE_EN
+    // remove all rate limit buckets
+    RATE_deinit();
+  #endif
+
+  #if OSC_EN
+    // close the sockets of the OSC destinations
+    OSC_deinit();
+
+    // release the routing trie
+    OSCROUTE_deinit();
+  #endif
+
   #ifdef WIN32
     // de-initialize windows socket API
     WSACleanup();
@@ -282,6 +341,11 @@ static void initConfig(void)
     strcpy(app.osc_host, OSC_DEFAULT_HOST);
     app.osc_port = OSC_DEFAULT_PORT;
     strcpy(app.osc_prefix, OSC_DEFAULT_PREFIX);
+    app.osc_window = OSC_DEFAULT_WINDOW;
+    app.osc_thread_cpu = -1;
+    app.osc_multicast_ttl = OSC_DEFAULT_MULTICAST_TTL;
+    app.osc_listen_port = OSCIN_DEFAULT_PORT;
+    app.osc_hub_port = OSCIN_DEFAULT_HUB_PORT;
 }
 
 /** 
@@ -320,6 +384,61 @@ static int callback_initFromFile(char *pParameter, char* pValue)
     {
         strncpy(app.osc_prefix, pValue, CONFIG_BUFFER_SIZE - 1);
     }
+    else if (strcmp("osc_route", pParameter) == 0)
+    {
+        if (app.osc_num_routes < CONFIG_OSC_ROUTES_MAX)
+            strncpy(app.osc_routes[app.osc_num_routes++], pValue, CONFIG_BUFFER_SIZE - 1);
+        else
+            printf("Too many OSC routes, \"%s\" ignored\n", pValue);
+    }
+    else if (strcmp("osc_window", pParameter) == 0)
+    {
+        app.osc_window = atoi(pValue);
+    }
+    else if (strcmp("osc_thread_cpu", pParameter) == 0)
+    {
+        app.osc_thread_cpu = atoi(pValue);
+    }
+    else if (strcmp("osc_thread_priority", pParameter) == 0)
+    {
+        app.osc_thread_priority = atoi(pValue);
+    }
+    else if (strcmp("osc_multicast_ttl", pParameter) == 0)
+    {
+        app.osc_multicast_ttl = atoi(pValue);
+    }
+    else if (strcmp("osc_multicast_if", pParameter) == 0)
+    {
+        strncpy(app.osc_multicast_if, pValue, CONFIG_BUFFER_SIZE - 1);
+    }
+    else if (strcmp("osc_listen_port", pParameter) == 0)
+    {
+        app.osc_listen_port = atoi(pValue);
+    }
+    else if (strcmp("osc_hub_port", pParameter) == 0)
+    {
+        app.osc_hub_port = atoi(pValue);
+    }
+    else if (strcmp("osc_hub_allow", pParameter) == 0)
+    {
+        strncpy(app.osc_hub_allow, pValue, CONFIG_BUFFER_SIZE - 1);
+    }
+    else if (strcmp("limit_read_rate", pParameter) == 0)
+    {
+        app.limit_read_rate = atoi(pValue);
+    }
+    else if (strcmp("limit_read_burst", pParameter) == 0)
+    {
+        app.limit_read_burst = atoi(pValue);
+    }
+    else if (strcmp("limit_write_rate", pParameter) == 0)
+    {
+        app.limit_write_rate = atoi(pValue);
+    }
+    else if (strcmp("limit_write_burst", pParameter) == 0)
+    {
+        app.limit_write_burst = atoi(pValue);
+    }
     else
     {
         return 0;
@@ -364,7 +483,6 @@ int main(int argc, char* argv[])
     }
 
     printf(APP_NAME" v"APP_VERSION" started on port %d\n", app.port);
-    printf("Routing \"%s...\" to OSC host %s:%d\n", app.osc_prefix, app.osc_host, app.osc_port);
 
     // set signals
     signal(SIGINT, on_signal);      // if user presses CTRL+C
@@ -378,6 +496,34 @@ int main(int argc, char* argv[])
     WSAStartup(0x0101, &wsaData);
   #endif
 
+  #if RATE_EN
+    // initialize rate limits
+    RATE_init();
+  #endif
+
+  #if OSC_EN
+    // initialize OSC module (sender thread)
+    OSC_init();
+
+    // build the routing trie of the OSC destinations
+    OSCROUTE_init();
+    {
+        const T_OSCROUTE_Destination *pDestination;
+        int i;
+        for (i = 0; (pDestination = OSCROUTE_get(i)) != NULL; i++)
+            printf("Routing \"%s...\" to OSC host %s:%d\n", pDestination->prefix, pDestination->host, pDestination->port);
+    }
+  #endif
+
+    // initialize routes, modules register theirs when initialized
+    ROUTE_init();
+    CGI_init();
+
+  #if PUSH_EN
+    // initialize push module
+    PUSH_init();
+  #endif
+
     // initialize data-pool
     DP_init(APP_CONFIG_FILE, app.onTheFlyAllocation);
 
@@ -388,13 +534,35 @@ int main(int argc, char* argv[])
     {
         sprintf(buffer, "%d", app.port);
         error_msg = mg_set_option(webserver, "listening_port", buffer);
+      #if OSCIN_EN
+        // listen for the OSC messages of the OSC host and of controllers
+        if (!error_msg && OSCIN_init(webserver))
+            printf("Failed to listen for OSC on port %d or %d\n", app.osc_listen_port, app.osc_hub_port);
+      #endif
+      #if OSC_TCP_EN
+        // connect the OSC hosts reached over TCP, packets sent so far are queued
+        OSCTCP_init(webserver);
+      #endif
         if (!error_msg)
         {
             // endless loop
             while (running)
             {
+                int timeout = 100;
                 DP_refresh();
-                mg_poll_server(webserver, 100);
+              #if OSC_EN
+                OSC_refresh();
+
+                // wake up when the collected OSC messages are due
+                timeout = OSC_getTimeout(timeout);
+              #endif
+                mg_poll_server(webserver, timeout);
+              #if OSC_EN
+                OSC_flush(0);
+              #endif
+              #if PUSH_EN
+                PUSH_flush();
+              #endif
             }
         }
     }
@@ -307,7 +307,9 @@ int ns_resolve(const char *domain_name, char *ip_addr_buf, size_t buf_len);
 #define NS_FREE free
 #endif
 
-#define NS_UDP_RECEIVE_BUFFER_SIZE  2000
+#ifndef NS_UDP_RECEIVE_BUFFER_SIZE
+#define NS_UDP_RECEIVE_BUFFER_SIZE  4096
+#endif
 #define NS_VPRINTF_BUFFER_SIZE      500
 
 struct ctl_msg {
@@ -1434,6 +1436,7 @@ enum endpoint_type {
 #define MG_CGI_CONN NSF_USER_3
 #define MG_PROXY_CONN NSF_USER_4
 #define MG_PROXY_DONT_PARSE NSF_USER_5
+#define MG_CLOSE_AFTER_RESPONSE NSF_USER_6
 
 struct connection {
   struct ns_connection *ns_conn;  // NOTE(lsm): main.c depends on this order
@@ -2628,6 +2631,39 @@ size_t mg_write(struct mg_connection *c, const void *buf, int len) {
   return conn->ns_conn->send_iobuf.len;
 }
 
+// Write straight to the socket when nothing is pending, buffer the rest.
+// Lets a caller stream a shared buffer without copying it per connection.
+size_t mg_write_direct(struct mg_connection *c, const void *buf, int len) {
+  struct connection *conn = MG_CONN_2_CONN(c);
+  struct ns_connection *nc = conn->ns_conn;
+  int n = 0;
+
+  if (nc->send_iobuf.len == 0 && len > 0 &&
+      !(nc->flags & NSF_BUFFER_BUT_DONT_SEND)
+#ifdef NS_ENABLE_SSL
+      && nc->ssl == NULL
+#endif
+      ) {
+    n = (int) send(nc->sock, buf, len, 0);
+    if (n > 0) {
+      nc->last_io_time = time(NULL);
+    } else if (ns_is_error(n)) {
+      nc->flags |= NSF_CLOSE_IMMEDIATELY;
+      return 0;
+    } else {
+      n = 0;
+    }
+  }
+  if (n < len) {
+    ns_send(nc, (const char *) buf + n, len - n);
+  }
+  return nc->send_iobuf.len;
+}
+
+size_t mg_send_pending(const struct mg_connection *c) {
+  return MG_CONN_2_CONN(c)->ns_conn->send_iobuf.len;
+}
+
 void mg_send_status(struct mg_connection *c, int status) {
   if (c->status_code == 0) {
     c->status_code = status;
@@ -2641,6 +2677,9 @@ void mg_send_header(struct mg_connection *c, const char *name, const char *v) {
     mg_printf(c, "HTTP/1.1 %d %s\r\n", 200, status_code_to_str(200));
   }
   mg_printf(c, "%s: %s\r\n", name, v);
+  if (!mg_strcasecmp(name, "Connection") && !mg_strcasecmp(v, "close")) {
+    MG_CONN_2_CONN(c)->ns_conn->flags |= MG_CLOSE_AFTER_RESPONSE;
+  }
 }
 
 static void terminate_headers(struct mg_connection *c) {
@@ -4682,6 +4721,116 @@ struct mg_connection *mg_connect(struct mg_server *server, const char *addr) {
   return &conn->mg_conn;
 }
 
+struct udp_listener {
+  mg_udp_handler_t handler;
+  void *param;
+};
+
+// UDP listeners keep user_data NULL, so mg_next() and the wakeup callbacks
+// never take them for HTTP connections.
+static void mg_udp_ev_handler(struct ns_connection *nc, int ev, void *p) {
+  struct udp_listener *ul = (struct udp_listener *) nc->proto_data;
+
+  if (ev == NS_RECV) {
+    char remote_ip[48] = "";
+#if defined(NS_ENABLE_IPV6)
+    inet_ntop(nc->sa.sa.sa_family, nc->sa.sa.sa_family == AF_INET ?
+              (void *) &nc->sa.sin.sin_addr :
+              (void *) &nc->sa.sin6.sin6_addr, remote_ip, sizeof(remote_ip));
+#elif defined(_WIN32)
+    strncpy(remote_ip, inet_ntoa(nc->sa.sin.sin_addr), sizeof(remote_ip) - 1);
+#else
+    inet_ntop(AF_INET, (void *) &nc->sa.sin.sin_addr, remote_ip,
+              sizeof(remote_ip));
+#endif
+    ul->handler(ul->param, nc->recv_iobuf.buf, * (int *) p, remote_ip);
+  } else if (ev == NS_CLOSE && (nc->flags & NSF_LISTENING)) {
+    free(ul);
+  }
+}
+
+int mg_bind_udp(struct mg_server *server, const char *addr,
+                mg_udp_handler_t handler, void *param) {
+  struct ns_connection *nc;
+  struct udp_listener *ul;
+  char buf[100];
+
+  if ((ul = (struct udp_listener *) calloc(1, sizeof(*ul))) == NULL) return -1;
+  ul->handler = handler;
+  ul->param = param;
+  snprintf(buf, sizeof(buf), "udp://%s", addr);
+  if ((nc = ns_bind(&server->ns_mgr, buf, mg_udp_ev_handler, NULL)) == NULL) {
+    free(ul);
+    return -1;
+  }
+  nc->proto_data = ul;
+  return 0;
+}
+
+struct tcp_client {
+  mg_tcp_handler_t handler;
+  void *param;
+};
+
+// Raw TCP client connections keep user_data NULL like the UDP listeners.
+// Received data is discarded, the handler is called when the connection is
+// established, on every poll of the server and when the connection is closed.
+// The send buffer is up to date on poll, unlike on NS_SEND.
+static void mg_tcp_ev_handler(struct ns_connection *nc, int ev, void *p) {
+  struct tcp_client *tc = (struct tcp_client *) nc->proto_data;
+  struct mg_tcp_connection *conn = (struct mg_tcp_connection *) nc;
+
+  switch (ev) {
+    case NS_CONNECT:
+      if (* (int *) p == 0) tc->handler(tc->param, conn, MG_TCP_CONNECT);
+      break;
+    case NS_POLL:
+      tc->handler(tc->param, conn, MG_TCP_POLL);
+      break;
+    case NS_RECV:
+      iobuf_remove(&nc->recv_iobuf, nc->recv_iobuf.len);
+      break;
+    case NS_CLOSE:
+      tc->handler(tc->param, conn, MG_TCP_CLOSE);
+      free(tc);
+      break;
+    default:
+      break;
+  }
+}
+
+struct mg_tcp_connection *mg_connect_tcp(struct mg_server *server,
+                                         const char *addr,
+                                         mg_tcp_handler_t handler,
+                                         void *param) {
+  struct ns_connection *nc;
+  struct tcp_client *tc;
+  char buf[100];
+
+  if ((tc = (struct tcp_client *) calloc(1, sizeof(*tc))) == NULL) return NULL;
+  tc->handler = handler;
+  tc->param = param;
+  snprintf(buf, sizeof(buf), "tcp://%s", addr);
+  if ((nc = ns_connect(&server->ns_mgr, buf, mg_tcp_ev_handler, NULL)) == NULL) {
+    free(tc);
+    return NULL;
+  }
+  nc->proto_data = tc;
+  return (struct mg_tcp_connection *) nc;
+}
+
+size_t mg_tcp_write(struct mg_tcp_connection *conn, const void *buf, int len) {
+  return ns_out((struct ns_connection *) conn, buf, len);
+}
+
+size_t mg_tcp_pending(const struct mg_tcp_connection *conn) {
+  return ((const struct ns_connection *) conn)->send_iobuf.len;
+}
+
+void mg_tcp_close(struct mg_tcp_connection *conn) {
+  ((struct ns_connection *) conn)->flags |= NSF_CLOSE_IMMEDIATELY;
+}
+
 #ifndef MONGOOSE_NO_LOGGING
 static void log_header(const struct mg_connection *conn, const char *header,
                        FILE *fp) {
@@ -4727,7 +4876,8 @@ static void close_local_endpoint(struct connection *conn) {
   struct mg_connection *c = &conn->mg_conn;
   // Must be done before free()
   int keep_alive = should_keep_alive(&conn->mg_conn) &&
-    (conn->endpoint_type == EP_FILE || conn->endpoint_type == EP_USER);
+    (conn->endpoint_type == EP_FILE || conn->endpoint_type == EP_USER) &&
+    !(conn->ns_conn->flags & MG_CLOSE_AFTER_RESPONSE);
   DBG(("%p %d %d %d", conn, conn->endpoint_type, keep_alive,
        conn->ns_conn->flags));
 
@@ -4765,7 +4915,8 @@ static void close_local_endpoint(struct connection *conn) {
   conn->cl = conn->num_bytes_recv = conn->request_len = 0;
   conn->ns_conn->flags &= ~(NSF_FINISHED_SENDING_DATA |
                             NSF_BUFFER_BUT_DONT_SEND | NSF_CLOSE_IMMEDIATELY |
-                            MG_HEADERS_SENT | MG_LONG_RUNNING);
+                            MG_HEADERS_SENT | MG_LONG_RUNNING |
+                            MG_CLOSE_AFTER_RESPONSE);
 
   // Do not memset() the whole structure, as some of the fields
   // (IP addresses & ports, server_param) must survive. Nullify the rest.
@@ -75,6 +75,14 @@ enum mg_event {
   MG_HTTP_ERROR   // If callback returns MG_FALSE, Mongoose continues with err
 };
 typedef int (*mg_handler_t)(struct mg_connection *, enum mg_event);
+typedef void (*mg_udp_handler_t)(void *param, const char *buf, int len,
+                                 const char *remote_ip);
+
+// Events of raw TCP client connections, see mg_connect_tcp()
+enum { MG_TCP_CONNECT, MG_TCP_POLL, MG_TCP_CLOSE };
+struct mg_tcp_connection;
+typedef void (*mg_tcp_handler_t)(void *param, struct mg_tcp_connection *,
+                                 int ev);
 
 // Websocket opcodes, from http://tools.ietf.org/html/rfc6455
 enum {
@@ -98,6 +106,13 @@ struct mg_connection *mg_next(struct mg_server *, struct mg_connection *);
 void mg_wakeup_server(struct mg_server *);
 void mg_wakeup_server_ex(struct mg_server *, mg_handler_t, const char *, ...);
 struct mg_connection *mg_connect(struct mg_server *, const char *);
+int mg_bind_udp(struct mg_server *, const char *addr, mg_udp_handler_t,
+                void *param);
+struct mg_tcp_connection *mg_connect_tcp(struct mg_server *, const char *addr,
+                                         mg_tcp_handler_t, void *param);
+size_t mg_tcp_write(struct mg_tcp_connection *, const void *buf, int len);
+size_t mg_tcp_pending(const struct mg_tcp_connection *);
+void mg_tcp_close(struct mg_tcp_connection *);
 
 // Connection management functions
 void mg_send_status(struct mg_connection *, int status_code);
@@ -105,6 +120,8 @@ void mg_send_header(struct mg_connection *, const char *name, const char *val);
 size_t mg_send_data(struct mg_connection *, const void *data, int data_len);
 size_t mg_printf_data(struct mg_connection *, const char *format, ...);
 size_t mg_write(struct mg_connection *, const void *buf, int len);
+size_t mg_write_direct(struct mg_connection *, const void *buf, int len);
+size_t mg_send_pending(const struct mg_connection *);
 size_t mg_printf(struct mg_connection *conn, const char *fmt, ...);
 
 size_t mg_websocket_write(struct mg_connection *, int opcode,
@@ -0,0 +1,383 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "release.h"
+#include "msgpack.h"
+
+/****************************************************************************/
+
+/**
+ * @brief Read a big-endian unsigned integer.
+ * @param pMPack Decoder
+ * @param size Number of bytes (1, 2, 4 or 8)
+ * @param pValue Value
+ * @return 0 on success, -1 if the data is truncated
+ */
+static int readBE(PT_MPack pMPack, int size, uint64_t *pValue)
+{
+    uint64_t value = 0;
+    int i;
+
+    if (pMPack->pEnd - pMPack->pData < size)
+        return -1;
+    for (i = 0; i < size; i++)
+        value = (value << 8) | *pMPack->pData++;
+    *pValue = value;
+    return 0;
+}
+
+/**
+ * @brief Read the data of a string, binary or extension.
+ * @param pMPack Decoder
+ * @param pObj Object receiving the data
+ * @param len Length of the data
+ * @return 0 on success, -1 if the data is truncated
+ */
+static int readData(PT_MPack pMPack, PT_MPackObject pObj, uint64_t len)
+{
+    if ((uint64_t)(pMPack->pEnd - pMPack->pData) < len)
+        return -1;
+    pObj->pData = (const char*)pMPack->pData;
+    pObj->len = (uint32_t)len;
+    pMPack->pData += len;
+    return 0;
+}
+
+/**
+ * @brief Append a type byte followed by a big-endian unsigned integer.
+ * @param pBuf String buffer
+ * @param type Type byte
+ * @param size Number of bytes of the integer (0, 1, 2, 4 or 8)
+ * @param value Integer
+ * @return 0 on success, -1 if out of memory
+ */
+static int appendBE(PT_StrBuf pBuf, unsigned char type, int size, uint64_t value)
+{
+    unsigned char data[9];
+    int i;
+
+    data[0] = type;
+    for (i = size; i > 0; i--)
+    {
+        data[i] = (unsigned char)value;
+        value >>= 8;
+    }
+    return STRBUF_append(pBuf, data, size + 1);
+}
+
+/****************************************************************************/
+
+/**
+ */
+void MPACK_init(PT_MPack pMPack, const void *pData, size_t len)
+{
+    pMPack->pData = (const unsigned char*)pData;
+    pMPack->pEnd = pMPack->pData + len;
+    pMPack->error = 0;
+}
+
+/**
+ */
+int MPACK_read(PT_MPack pMPack, PT_MPackObject pObj)
+{
+    uint64_t value = 0;
+    unsigned char type;
+    int ret = 0;
+
+    if (pMPack->error || pMPack->pData >= pMPack->pEnd)
+    {
+        pMPack->error = 1;
+        return -1;
+    }
+
+    type = *pMPack->pData++;
+    pObj->pData = NULL;
+    pObj->len = 0;
+
+    if (type <= 0x7F)
+    {
+        // positive fixint
+        pObj->type = MPACK_UINT;
+        pObj->v.u = type;
+    }
+    else if (type >= 0xE0)
+    {
+        // negative fixint
+        pObj->type = MPACK_INT;
+        pObj->v.i = (int8_t)type;
+    }
+    else if ((type & 0xF0) == 0x80)
+    {
+        pObj->type = MPACK_MAP;
+        pObj->len = type & 0x0F;
+    }
+    else if ((type & 0xF0) == 0x90)
+    {
+        pObj->type = MPACK_ARRAY;
+        pObj->len = type & 0x0F;
+    }
+    else if ((type & 0xE0) == 0xA0)
+    {
+        pObj->type = MPACK_STR;
+        ret = readData(pMPack, pObj, type & 0x1F);
+    }
+    else
+    {
+        switch (type)
+        {
+            case 0xC0:
+                pObj->type = MPACK_NIL;
+                break;
+            case 0xC2:
+            case 0xC3:
+                pObj->type = MPACK_BOOL;
+                pObj->v.b = type == 0xC3;
+                break;
+            case 0xC4:
+            case 0xC5:
+            case 0xC6:
+                pObj->type = MPACK_BIN;
+                ret = readBE(pMPack, 1 << (type - 0xC4), &value) || readData(pMPack, pObj, value);
+                break;
+            case 0xC7:
+            case 0xC8:
+            case 0xC9:
+                // extension: length, type, data
+                pObj->type = MPACK_EXT;
+                ret = readBE(pMPack, 1 << (type - 0xC7), &value) || readData(pMPack, pObj, value + 1);
+                break;
+            case 0xCA:
+            {
+                union { uint32_t u; float f; } conv;
+                pObj->type = MPACK_FLOAT;
+                ret = readBE(pMPack, 4, &value);
+                conv.u = (uint32_t)value;
+                pObj->v.f = conv.f;
+                break;
+            }
+            case 0xCB:
+            {
+                union { uint64_t u; double f; } conv;
+                pObj->type = MPACK_FLOAT;
+                ret = readBE(pMPack, 8, &value);
+                conv.u = value;
+                pObj->v.f = conv.f;
+                break;
+            }
+            case 0xCC:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF:
+                pObj->type = MPACK_UINT;
+                ret = readBE(pMPack, 1 << (type - 0xCC), &pObj->v.u);
+                break;
+            case 0xD0:
+                pObj->type = MPACK_INT;
+                ret = readBE(pMPack, 1, &value);
+                pObj->v.i = (int8_t)value;
+                break;
+            case 0xD1:
+                pObj->type = MPACK_INT;
+                ret = readBE(pMPack, 2, &value);
+                pObj->v.i = (int16_t)value;
+                break;
+            case 0xD2:
+                pObj->type = MPACK_INT;
+                ret = readBE(pMPack, 4, &value);
+                pObj->v.i = (int32_t)value;
+                break;
+            case 0xD3:
+                pObj->type = MPACK_INT;
+                ret = readBE(pMPack, 8, &value);
+                pObj->v.i = (int64_t)value;
+                break;
+            case 0xD4:
+            case 0xD5:
+            case 0xD6:
+            case 0xD7:
+            case 0xD8:
+                // fixext: type and 1 to 16 bytes of data
+                pObj->type = MPACK_EXT;
+                ret = readData(pMPack, pObj, (1 << (type - 0xD4)) + 1);
+                break;
+            case 0xD9:
+            case 0xDA:
+            case 0xDB:
+                pObj->type = MPACK_STR;
+                ret = readBE(pMPack, 1 << (type - 0xD9), &value) || readData(pMPack, pObj, value);
+                break;
+            case 0xDC:
+            case 0xDD:
+                pObj->type = MPACK_ARRAY;
+                ret = readBE(pMPack, 2 << (type - 0xDC), &value);
+                pObj->len = (uint32_t)value;
+                break;
+            case 0xDE:
+            case 0xDF:
+                pObj->type = MPACK_MAP;
+                ret = readBE(pMPack, 2 << (type - 0xDE), &value);
+                pObj->len = (uint32_t)value;
+                break;
+            default:
+                // 0xC1 is never used
+                ret = -1;
+                break;
+        }
+    }
+
+    if (ret)
+    {
+        pMPack->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ */
+int MPACK_skip(PT_MPack pMPack)
+{
+    T_MPackObject obj;
+    uint64_t count = 1;
+
+    while (count)
+    {
+        count--;
+        if (MPACK_read(pMPack, &obj))
+            return -1;
+        if (obj.type == MPACK_ARRAY)
+            count += obj.len;
+        else if (obj.type == MPACK_MAP)
+            count += 2 * (uint64_t)obj.len;
+
+        // every element needs at least one byte
+        if (count > (uint64_t)(pMPack->pEnd - pMPack->pData))
+        {
+            pMPack->error = 1;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ */
+int MPACK_toString(PT_MPackObject pObj, char *pBuf, size_t size)
+{
+    size_t len;
+    int precision;
+
+    if (size == 0)
+        return -1;
+
+    switch (pObj->type)
+    {
+        case MPACK_NIL:
+            *pBuf = '\0';
+            break;
+        case MPACK_BOOL:
+            snprintf(pBuf, size, "%s", pObj->v.b ? "true" : "false");
+            break;
+        case MPACK_UINT:
+            snprintf(pBuf, size, "%llu", (unsigned long long)pObj->v.u);
+            break;
+        case MPACK_INT:
+            snprintf(pBuf, size, "%lld", (long long)pObj->v.i);
+            break;
+        case MPACK_FLOAT:
+            // shortest representation which reads back to the same value
+            for (precision = 6; precision < 17; precision++)
+            {
+                snprintf(pBuf, size, "%.*g", precision, pObj->v.f);
+                if (strtod(pBuf, NULL) == pObj->v.f)
+                    break;
+            }
+            if (precision == 17)
+                snprintf(pBuf, size, "%.17g", pObj->v.f);
+            break;
+        case MPACK_STR:
+        case MPACK_BIN:
+            len = pObj->len < size - 1 ? pObj->len : size - 1;
+            memcpy(pBuf, pObj->pData, len);
+            pBuf[len] = '\0';
+            break;
+        default:
+            *pBuf = '\0';
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ */
+int MPACK_appendMap(PT_StrBuf pBuf, uint32_t count)
+{
+    if (count < 16)
+        return appendBE(pBuf, 0x80 | count, 0, 0);
+    if (count <= 0xFFFF)
+        return appendBE(pBuf, 0xDE, 2, count);
+    return appendBE(pBuf, 0xDF, 4, count);
+}
+
+/**
+ */
+int MPACK_appendArray(PT_StrBuf pBuf, uint32_t count)
+{
+    if (count < 16)
+        return appendBE(pBuf, 0x90 | count, 0, 0);
+    if (count <= 0xFFFF)
+        return appendBE(pBuf, 0xDC, 2, count);
+    return appendBE(pBuf, 0xDD, 4, count);
+}
+
+/**
+ */
+int MPACK_appendStr(PT_StrBuf pBuf, const char *pStr, size_t len)
+{
+    int ret;
+
+    if (len < 32)
+        ret = appendBE(pBuf, 0xA0 | len, 0, 0);
+    else if (len <= 0xFF)
+        ret = appendBE(pBuf, 0xD9, 1, len);
+    else if (len <= 0xFFFF)
+        ret = appendBE(pBuf, 0xDA, 2, len);
+    else
+        ret = appendBE(pBuf, 0xDB, 4, len);
+
+    if (ret)
+        return -1;
+    return STRBUF_append(pBuf, pStr, len);
+}
+
+/**
+ */
+int MPACK_appendUint(PT_StrBuf pBuf, uint64_t value)
+{
+    if (value <= 0x7F)
+        return appendBE(pBuf, (unsigned char)value, 0, 0);
+    if (value <= 0xFF)
+        return appendBE(pBuf, 0xCC, 1, value);
+    if (value <= 0xFFFF)
+        return appendBE(pBuf, 0xCD, 2, value);
+    if (value <= 0xFFFFFFFFu)
+        return appendBE(pBuf, 0xCE, 4, value);
+    return appendBE(pBuf, 0xCF, 8, value);
+}
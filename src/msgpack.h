@@ -0,0 +1,158 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file msgpack.h
+ *  @brief MessagePack encoder and decoder.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _MSGPACK_H_
+#define _MSGPACK_H_
+
+#include <stdint.h>
+#include "strbuf.h"
+
+/**
+ * @addtogroup UTILITIES
+ * @{
+ */
+
+/**
+ * @defgroup MPACK MessagePack
+ * @brief MessagePack encoder and decoder.
+ *
+ * Objects are decoded one header at a time directly from the received
+ * buffer: strings, binaries and extensions point into this buffer and are
+ * not terminated with '\\0'. Arrays and maps only return their number of
+ * elements, the elements follow. Objects are encoded by appending them to
+ * a string buffer, always with the smallest possible format.
+ * @{
+ */
+
+/** @brief Types of MessagePack objects */
+typedef enum
+{
+    MPACK_NIL,                      /**< nil */
+    MPACK_BOOL,                     /**< true or false */
+    MPACK_UINT,                     /**< positive integer */
+    MPACK_INT,                      /**< negative integer */
+    MPACK_FLOAT,                    /**< float 32 or float 64 */
+    MPACK_STR,                      /**< string */
+    MPACK_BIN,                      /**< binary */
+    MPACK_ARRAY,                    /**< array */
+    MPACK_MAP,                      /**< map */
+    MPACK_EXT                       /**< extension */
+} T_MPackType;
+
+/** @brief Decoded MessagePack object */
+typedef struct t_MPackObject
+{
+    T_MPackType type;               /**< type of the object */
+    union
+    {
+        int      b;                 /**< value of a boolean */
+        uint64_t u;                 /**< value of a positive integer */
+        int64_t  i;                 /**< value of a negative integer */
+        double   f;                 /**< value of a float */
+    } v;
+    const char *pData;              /**< data of a string, binary or extension */
+    uint32_t len;                   /**< length of the data or number of elements of an array or map */
+} T_MPackObject, *PT_MPackObject;
+
+/** @brief MessagePack decoder */
+typedef struct t_MPack
+{
+    const unsigned char *pData;     /**< next byte to decode */
+    const unsigned char *pEnd;      /**< end of the data */
+    int error;                      /**< set if the data is truncated or invalid */
+} T_MPack, *PT_MPack;
+
+/**
+ * @brief Initialize a decoder.
+ * @param pMPack Decoder
+ * @param pData Data to decode
+ * @param len Length of the data
+ */
+void MPACK_init(PT_MPack pMPack, const void *pData, size_t len);
+
+/**
+ * @brief Decode the next object.
+ * @param pMPack Decoder
+ * @param pObj Decoded object
+ * @return 0 on success, -1 if the data is truncated or invalid
+ */
+int MPACK_read(PT_MPack pMPack, PT_MPackObject pObj);
+
+/**
+ * @brief Skip the next object including all elements of an array or map.
+ * @param pMPack Decoder
+ * @return 0 on success, -1 if the data is truncated or invalid
+ */
+int MPACK_skip(PT_MPack pMPack);
+
+/**
+ * @brief Convert a scalar object to a string.
+ * Numbers are printed in decimal, booleans as "true" or "false" and nil as
+ * an empty string. Strings and binaries are copied. The result is truncated
+ * to the buffer size.
+ * @param pObj Decoded object
+ * @param pBuf Buffer receiving the string
+ * @param size Size of the buffer
+ * @return 0 on success, -1 if the object is an array, map or extension
+ */
+int MPACK_toString(PT_MPackObject pObj, char *pBuf, size_t size);
+
+/**
+ * @brief Append the header of a map.
+ * @param pBuf String buffer
+ * @param count Number of key-value pairs following
+ * @return 0 on success, -1 if out of memory
+ */
+int MPACK_appendMap(PT_StrBuf pBuf, uint32_t count);
+
+/**
+ * @brief Append the header of an array.
+ * @param pBuf String buffer
+ * @param count Number of elements following
+ * @return 0 on success, -1 if out of memory
+ */
+int MPACK_appendArray(PT_StrBuf pBuf, uint32_t count);
+
+/**
+ * @brief Append a string.
+ * @param pBuf String buffer
+ * @param pStr String
+ * @param len Length of the string
+ * @return 0 on success, -1 if out of memory
+ */
+int MPACK_appendStr(PT_StrBuf pBuf, const char *pStr, size_t len);
+
+/**
+ * @brief Append a positive integer.
+ * @param pBuf String buffer
+ * @param value Value
+ * @return 0 on success, -1 if out of memory
+ */
+int MPACK_appendUint(PT_StrBuf pBuf, uint64_t value);
+
+/** @} MPACK */
+
+/** @} UTILITIES */
+
+#endif // _MSGPACK_H_
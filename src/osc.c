@@ -17,20 +17,41 @@
  *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
  ****************************************************************************/
 
+#if defined(LINUX) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE               // pthread_setaffinity_np()
+#endif
+
 #include "osc.h"
 
 #if OSC_EN
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <errno.h>
 #include "OSC-client.h"
+#include "OSC-timetag.h"
+#include "utils.h"
+#if OSC_TCP_EN
+  #include "osc_tcp.h"
+#endif
+#if OSC_THREAD_EN
+  #include <pthread.h>
+  #include <sched.h>
+  #include <signal.h>
+#endif
 #ifdef _WIN32
-  #include <winsock.h>
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
   typedef SOCKET sock_t;
 #else
   #include <sys/socket.h>
   #include <netinet/in.h>
+  #include <arpa/inet.h>
+  #include <net/if.h>
   #include <netdb.h>
   #include <unistd.h>
   #define SOCKET                 int
@@ -43,56 +64,603 @@
 /** OSC buffer containing a whole message bundle */
 #define OSC_BUFFER_SIZE             4096
 
+/** Maximal nesting depth of bundles */
+#define OSC_BUNDLE_DEPTH_MAX        8
+
 /** output buffer */
 static char osc_buffer[OSC_BUFFER_SIZE];
 
 /** OSC buffer */
 static OSCbuf osc;
 
+/** Type tags of the argument types, in the order of T_OSC_ArgType */
+static const char typeTags[] = "ifshdbTFNt";
+
+/** Data of the last blob decoded by OSC_getArgType() */
+static char blobData[DP_VALUE_LENGTH_MAX / 2];
+
 static int isBundle = 0;
 
+/** @brief OSC destination with a connected UDP socket */
+typedef struct t_OSC_Transport
+{
+    char host[CONFIG_BUFFER_SIZE];      /**< host name or IP, empty if the entry is free */
+    int port;                           /**< port number */
+    SOCKET s;                           /**< socket connected to the host, INVALID_SOCKET if not resolved */
+    struct sockaddr_storage addr;       /**< address the socket is connected to */
+    socklen_t addrLen;                  /**< length of the address */
+    time_t resolved;                    /**< time of the last address resolution */
+    unsigned long lastUsed;             /**< time stamp of the last use (LRU) */
+} T_OSC_Transport, *PT_OSC_Transport;
+
+/** OSC destinations */
+static T_OSC_Transport transports[OSC_MAX_DESTINATIONS];
+
+/** Counter used to find the least recently used destination */
+static unsigned long useCounter = 0;
+
+/** Maximal length of the address of a collected message */
+#define OSC_ADDRESS_MAX             256
+
+/** @brief Message collected before it is sent */
+typedef struct t_OSC_Queued
+{
+    unsigned int hash;                  /**< hash of the address */
+    const char *host;                   /**< host where the message should be sent */
+    int port;                           /**< port number of the host */
+    char address[OSC_ADDRESS_MAX];      /**< OSC address */
+    T_OSC_ArgType arg;                  /**< argument, a string or blob points to value */
+    char value[DP_VALUE_LENGTH_MAX];    /**< string or blob argument */
+} T_OSC_Queued, *PT_OSC_Queued;
+
+/** Messages collected before they are sent, one per address */
+static T_OSC_Queued queue[OSC_QUEUE_SIZE];
+
+/** Number of collected messages */
+static int numQueued = 0;
+
+/** Time the first collected message was queued in microseconds */
+static unsigned long long queuedUs = 0;
+
+/** Set while sendQueue() sends the collected messages */
+static int sendingQueue = 0;
+
+/** Statistics of the sent packets, updated by the sender thread */
+static T_OSC_Stats stats;
+
+#if OSC_THREAD_EN
+
+/** @brief Packet in the ring of the sender thread */
+typedef struct t_OSC_Record
+{
+    unsigned int size;              /**< size of the record with header and padding, 0 marks the end of the ring */
+    int len;                        /**< length of the packet */
+    int port;                       /**< port number of the host */
+    unsigned long long queuedUs;    /**< time the packet was queued in microseconds */
+} T_OSC_Record, *PT_OSC_Record;     // followed by the host name ('\0' terminated) and the packet
+
+/** Ring of packets from the main thread (producer) to the sender thread (consumer) */
+static char ring[OSC_RING_SIZE] __attribute__((aligned(8)));
+
+/** Position of the next record read by the sender thread */
+static unsigned int ringHead = 0;
+
+/** Position of the next record written by the main thread */
+static unsigned int ringTail = 0;
+
+/** Set while the sender thread waits for packets */
+static int senderSleeping = 0;
+
+/** Set while the sender thread runs */
+static int senderRunning = 0;
+
+/** Sender thread */
+static pthread_t sender;
+
+/** Mutex of the wake up condition */
+static pthread_mutex_t senderMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Condition signaled when a packet is queued to the sleeping sender thread */
+static pthread_cond_t senderWakeUp = PTHREAD_COND_INITIALIZER;
+
+#endif // OSC_THREAD_EN
+
 /****************************************************************************/
 
 /**
- * @brief Send a UDP packet.
+ * @brief Set the options of a socket for its destination address.
+ * Broadcasts are allowed on IPv4 sockets, so that broadcast addresses
+ * (e.g. 192.168.1.255) can be used as destinations. Multicast groups get the
+ * TTL (hop limit) app.osc_multicast_ttl and are sent on the interface
+ * app.osc_multicast_if (an address or, on Linux, an interface name) if set.
+ * @param s Socket
+ * @param pAddr Destination address
+ */
+static void setSocketOptions(SOCKET s, const struct sockaddr *pAddr)
+{
+    int ttl = app.osc_multicast_ttl;
+
+    if (pAddr->sa_family == AF_INET)
+    {
+        int on = 1;
+        setsockopt(s, SOL_SOCKET, SO_BROADCAST, (const char*)&on, sizeof(on));
+
+        if (IN_MULTICAST(ntohl(((const struct sockaddr_in*)pAddr)->sin_addr.s_addr)))
+        {
+            setsockopt(s, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&ttl, sizeof(ttl));
+            if (app.osc_multicast_if[0])
+            {
+                struct in_addr addr;
+                if (inet_pton(AF_INET, app.osc_multicast_if, &addr) == 1)
+                {
+                    setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&addr, sizeof(addr));
+                }
+              #if defined(LINUX)
+                else
+                {
+                    struct ip_mreqn mreq;
+                    memset(&mreq, 0, sizeof(mreq));
+                    mreq.imr_ifindex = (int)if_nametoindex(app.osc_multicast_if);
+                    setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof(mreq));
+                }
+              #endif
+            }
+        }
+    }
+    else if (pAddr->sa_family == AF_INET6 &&
+             IN6_IS_ADDR_MULTICAST(&((const struct sockaddr_in6*)pAddr)->sin6_addr))
+    {
+        setsockopt(s, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, (const char*)&ttl, sizeof(ttl));
+      #if defined(LINUX)
+        if (app.osc_multicast_if[0])
+        {
+            unsigned int index = if_nametoindex(app.osc_multicast_if);
+            setsockopt(s, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index));
+        }
+      #endif
+    }
+}
+
+/**
+ * @brief Resolve the address of a destination and connect its socket.
+ * The socket is only replaced if the address changed. If the resolution
+ * fails the current socket is kept.
+ * @param pTransport Destination
+ */
+static void resolve(PT_OSC_Transport pTransport)
+{
+    struct addrinfo hints;
+    struct addrinfo *pList;
+    struct addrinfo *pInfo;
+    char port[8];
+
+    pTransport->resolved = time(NULL);
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    sprintf(port, "%d", pTransport->port);
+    if (getaddrinfo(pTransport->host, port, &hints, &pList) != 0)
+        return;
+
+    for (pInfo = pList; pInfo; pInfo = pInfo->ai_next)
+    {
+        SOCKET s;
+
+        // nothing to do if the address did not change
+        if (pTransport->s != INVALID_SOCKET && (socklen_t)pInfo->ai_addrlen == pTransport->addrLen &&
+            memcmp(pInfo->ai_addr, &pTransport->addr, pTransport->addrLen) == 0)
+            break;
+
+        // open a UDP socket connected to the address
+        s = socket(pInfo->ai_family, pInfo->ai_socktype, pInfo->ai_protocol);
+        if (s == INVALID_SOCKET)
+            continue;
+        setSocketOptions(s, pInfo->ai_addr);
+        if (connect(s, pInfo->ai_addr, (socklen_t)pInfo->ai_addrlen) != 0)
+        {
+            closesocket(s);
+            continue;
+        }
+
+        if (pTransport->s != INVALID_SOCKET)
+            closesocket(pTransport->s);
+        pTransport->s = s;
+        memcpy(&pTransport->addr, pInfo->ai_addr, pInfo->ai_addrlen);
+        pTransport->addrLen = (socklen_t)pInfo->ai_addrlen;
+        break;
+    }
+    freeaddrinfo(pList);
+}
+
+/**
+ * @brief Close the socket of a destination and free its entry.
+ * @param pTransport Destination
+ */
+static void closeTransport(PT_OSC_Transport pTransport)
+{
+    if (pTransport->host[0] && pTransport->s != INVALID_SOCKET)
+        closesocket(pTransport->s);
+    memset(pTransport, 0, sizeof(T_OSC_Transport));
+    pTransport->s = INVALID_SOCKET;
+}
+
+/**
+ * @brief Get the destination of a host, a new destination is resolved.
+ * If all entries are used, the least recently used one is replaced.
+ * @param host Host name or IP
+ * @param port Port number of the host
+ * @return Destination
+ */
+static PT_OSC_Transport getTransport(const char *host, int port)
+{
+    PT_OSC_Transport pTransport = &transports[0];
+    int i;
+
+    for (i = 0; i < OSC_MAX_DESTINATIONS; i++)
+    {
+        if (transports[i].port == port && strcmp(transports[i].host, host) == 0)
+        {
+            transports[i].lastUsed = ++useCounter;
+            return &transports[i];
+        }
+        if (transports[i].lastUsed < pTransport->lastUsed)
+            pTransport = &transports[i];
+    }
+
+    closeTransport(pTransport);
+    strncpy(pTransport->host, host, CONFIG_BUFFER_SIZE - 1);
+    pTransport->port = port;
+    pTransport->lastUsed = ++useCounter;
+    resolve(pTransport);
+    return pTransport;
+}
+
+/**
+ * @brief Resolve the addresses of the destinations again if they are due.
+ */
+static void refreshTransports(void)
+{
+    time_t now = time(NULL);
+    int i;
+
+    for (i = 0; i < OSC_MAX_DESTINATIONS; i++)
+    {
+        if (transports[i].host[0] && now - transports[i].resolved >= OSC_RESOLVE_INTERVAL)
+            resolve(&transports[i]);
+    }
+}
+
+/**
+ * @brief Send a batch of UDP packets to the same destination at once.
+ * With sendmmsg() the whole batch costs one system call, otherwise each
+ * packet is sent on its own.
+ * @param host Host where the packets should be sent
+ * @param port Port number of the host
+ * @param ppBuffers packets to send
+ * @param pLens Lengths of the packets
+ * @param count Number of packets, at most OSC_BATCH_SIZE
+ * @return number of packets sent
+ */
+static int sendBatch(const char *host, int port, const char **ppBuffers, const int *pLens, int count)
+{
+    PT_OSC_Transport pTransport = getTransport(host, port);
+    unsigned long syscalls = 0;
+    int sent = 0;
+    int i;
+
+    if (pTransport->s != INVALID_SOCKET)
+    {
+      #if OSC_SENDMMSG_EN
+        struct mmsghdr msgs[OSC_BATCH_SIZE];
+        struct iovec iovs[OSC_BATCH_SIZE];
+        int retried = 0;
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * count);
+        for (i = 0; i < count; i++)
+        {
+            iovs[i].iov_base = (void*)ppBuffers[i];
+            iovs[i].iov_len = pLens[i];
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        i = 0;
+        while (i < count)
+        {
+            int n = sendmmsg(pTransport->s, &msgs[i], count - i, 0);
+            syscalls++;
+            if (n > 0)
+            {
+                i += n;
+                sent += n;
+                retried = 0;
+            }
+            else if (!retried)
+            {
+                // a connected socket reports an error of a previous packet
+                // (e.g. port unreachable) on the next send, try again once
+                retried = 1;
+            }
+            else
+            {
+                // skip the packet which cannot be sent
+                i++;
+                retried = 0;
+            }
+        }
+      #else
+        for (i = 0; i < count; i++)
+        {
+            // a connected socket reports an error of a previous packet (e.g.
+            // port unreachable) on the next send, try again once
+            syscalls++;
+            if (send(pTransport->s, ppBuffers[i], pLens[i], 0) == pLens[i])
+            {
+                sent++;
+                continue;
+            }
+            syscalls++;
+            if (send(pTransport->s, ppBuffers[i], pLens[i], 0) == pLens[i])
+                sent++;
+        }
+      #endif
+    }
+
+    __atomic_add_fetch(&stats.sent, sent, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats.failed, count - sent, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats.syscalls, syscalls, __ATOMIC_RELAXED);
+    return sent;
+}
+
+/**
+ * @brief Send a UDP packet at once.
  * @param host Host where packet should be sent
  * @param port Port number of the host
  * @param pBuffer packet to send
  * @param len Length of the packet
  * @return 0 on success
  */
-static int sendUDP(const char *host, int port, const char *pBuffer, int len)
+static int sendNow(const char *host, int port, const char *pBuffer, int len)
 {
-    int ret = 0;
-    SOCKET s;
-    struct sockaddr_in servaddr;
-    struct hostent *he;
+    return sendBatch(host, port, &pBuffer, &len, 1) == 1 ? 0 : -1;
+}
+
+#if OSC_THREAD_EN
 
-    // open a UDP socket
-    s = socket(AF_INET, SOCK_DGRAM, 0);
-    if (s == INVALID_SOCKET)
+/**
+ * @brief Queue a packet to the sender thread.
+ * Only the main thread calls this function.
+ * @param host Host where packet should be sent
+ * @param port Port number of the host
+ * @param pBuffer packet to send
+ * @param len Length of the packet
+ * @return 0 on success, -1 if the ring is full (the packet is dropped)
+ */
+static int queuePacket(const char *host, int port, const char *pBuffer, int len)
+{
+    size_t hostLen = strlen(host) + 1;
+    unsigned int size = (unsigned int)((sizeof(T_OSC_Record) + hostLen + len + 7) & ~(size_t)7);
+    unsigned int tail = ringTail;
+    unsigned int head = __atomic_load_n(&ringHead, __ATOMIC_ACQUIRE);
+    unsigned int offset = tail & (OSC_RING_SIZE - 1);
+    unsigned int contiguous = OSC_RING_SIZE - offset;
+    unsigned int needed = size <= contiguous ? size : contiguous + size;
+    PT_OSC_Record pRecord;
+
+    if (needed > OSC_RING_SIZE - (tail - head))
+    {
+        __atomic_add_fetch(&stats.dropped, 1, __ATOMIC_RELAXED);
         return -1;
+    }
+
+    // records are not split, skip the end of the ring
+    if (size > contiguous)
+    {
+        ((PT_OSC_Record)(ring + offset))->size = 0;
+        tail += contiguous;
+        offset = 0;
+    }
+
+    pRecord = (PT_OSC_Record)(ring + offset);
+    pRecord->size = size;
+    pRecord->len = len;
+    pRecord->port = port;
+    pRecord->queuedUs = SYS_getMicroseconds();
+    memcpy(pRecord + 1, host, hostLen);
+    memcpy((char*)(pRecord + 1) + hostLen, pBuffer, len);
+
+    // publish the record, then wake up the sender thread if it sleeps
+    __atomic_store_n(&ringTail, tail + size, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&senderSleeping, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&senderMutex);
+        pthread_cond_signal(&senderWakeUp);
+        pthread_mutex_unlock(&senderMutex);
+    }
+    return 0;
+}
 
-    // set family and port
-    memset((void *)&servaddr, 0, sizeof(struct sockaddr_in));
-    servaddr.sin_family = AF_INET;
-    servaddr.sin_port   = htons(port);
-    he = gethostbyname(host);
-    servaddr.sin_addr = * (struct in_addr *) he->h_addr_list[0];
+/**
+ * @brief Send the packets queued in the ring.
+ * Consecutive packets to the same destination are sent as one batch.
+ * Only the sender thread calls this function.
+ * @return Number of packets sent
+ */
+static int sendQueued(void)
+{
+    unsigned int head = ringHead;
+    unsigned int tail = __atomic_load_n(&ringTail, __ATOMIC_ACQUIRE);
+    int count = 0;
 
-    // send UDP packet
-    if (sendto(s, pBuffer, len, 0, (struct sockaddr *)&servaddr, sizeof(struct sockaddr_in)) == -1)
-        ret = -1;
+    while (head != tail)
+    {
+        PT_OSC_Record pRecords[OSC_BATCH_SIZE];
+        const char *ppBuffers[OSC_BATCH_SIZE];
+        int lens[OSC_BATCH_SIZE];
+        const char *host = NULL;
+        unsigned long long now;
+        int n = 0;
+        int i;
 
-    // close socket
-    closesocket(s);
+        // collect the packets of a batch, the records stay in the ring
+        // until the batch is sent
+        while (head != tail && n < OSC_BATCH_SIZE)
+        {
+            PT_OSC_Record pRecord = (PT_OSC_Record)(ring + (head & (OSC_RING_SIZE - 1)));
+            if (pRecord->size == 0)
+            {
+                // end of the ring
+                head += OSC_RING_SIZE - (head & (OSC_RING_SIZE - 1));
+                continue;
+            }
+            if (n > 0 && (pRecord->port != pRecords[0]->port || strcmp((const char*)(pRecord + 1), host) != 0))
+                break;
+            if (n == 0)
+                host = (const char*)(pRecord + 1);
+            pRecords[n] = pRecord;
+            ppBuffers[n] = (const char*)(pRecord + 1) + strlen(host) + 1;
+            lens[n] = pRecord->len;
+            head += pRecord->size;
+            n++;
+        }
 
-    return ret;
+        if (n > 0)
+        {
+            sendBatch(host, pRecords[0]->port, ppBuffers, lens, n);
+            now = SYS_getMicroseconds();
+            for (i = 0; i < n; i++)
+            {
+                unsigned long long latency = now - pRecords[i]->queuedUs;
+                __atomic_add_fetch(&stats.totalLatencyUs, latency, __ATOMIC_RELAXED);
+                if (latency > stats.maxLatencyUs)
+                    __atomic_store_n(&stats.maxLatencyUs, latency, __ATOMIC_RELAXED);
+            }
+            count += n;
+        }
+        __atomic_store_n(&ringHead, head, __ATOMIC_RELEASE);
+    }
+    return count;
 }
 
 /**
+ * @brief Set the CPU and the priority of the sender thread.
+ * Failures are reported but do not stop the thread.
  */
-int OSC_initMessages(int bundle)
+static void setSchedule(void)
+{
+    if (app.osc_thread_cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(app.osc_thread_cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+            printf("OSC sender thread not pinned to CPU %d\n", app.osc_thread_cpu);
+    }
+    if (app.osc_thread_priority > 0)
+    {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = app.osc_thread_priority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+            printf("OSC sender thread priority %d not set (SCHED_FIFO)\n", app.osc_thread_priority);
+    }
+}
+
+/**
+ * @brief Sender thread.
+ * The thread owns the sockets of the destinations. It sends the queued
+ * packets, resolves the addresses again when due and sleeps while the ring
+ * is empty. When stopped, it sends the remaining packets first.
+ * @param pParam Not used
+ * @return NULL
+ */
+static void* senderThread(void *pParam)
+{
+    sigset_t signals;
+
+    // signals are handled by the main thread
+    sigfillset(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    setSchedule();
+
+    while (__atomic_load_n(&senderRunning, __ATOMIC_ACQUIRE))
+    {
+        if (sendQueued())
+            continue;
+
+        // sleep until a packet is queued, the ring is checked again after
+        // announcing it, so no wake up is lost
+        pthread_mutex_lock(&senderMutex);
+        __atomic_store_n(&senderSleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ringTail, __ATOMIC_SEQ_CST) == ringHead &&
+            __atomic_load_n(&senderRunning, __ATOMIC_ACQUIRE))
+        {
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += 1;
+            pthread_cond_timedwait(&senderWakeUp, &senderMutex, &until);
+        }
+        __atomic_store_n(&senderSleeping, 0, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&senderMutex);
+
+        refreshTransports();
+    }
+
+    sendQueued();
+    return NULL;
+}
+
+#endif // OSC_THREAD_EN
+
+/**
+ * @brief Send a packet.
+ * Packets to hosts named OSCTCP_SCHEME "host" are passed to the TCP
+ * transport, which may coalesce the messages collected by sendQueue(). With
+ * the sender thread UDP packets are queued, else they are sent at once.
+ * @param host Host where packet should be sent
+ * @param port Port number of the host
+ * @param pBuffer packet to send
+ * @param len Length of the packet
+ * @return 0 on success
+ */
+static int sendPacket(const char *host, int port, const char *pBuffer, int len)
+{
+  #if OSC_TCP_EN
+    if (strncmp(host, OSCTCP_SCHEME, sizeof(OSCTCP_SCHEME) - 1) == 0)
+        return OSCTCP_send(host + sizeof(OSCTCP_SCHEME) - 1, port, pBuffer, len, sendingQueue);
+  #endif
+  #if OSC_THREAD_EN
+    if (senderRunning)
+        return queuePacket(host, port, pBuffer, len);
+  #endif
+    return sendNow(host, port, pBuffer, len);
+}
+
+/**
+ * @brief Convert a time tag to the type of the OSC library.
+ * @param timeTag Time tag in NTP format
+ * @return Time tag
+ */
+static OSCTimeTag toTimeTag(unsigned long long timeTag)
+{
+  #ifdef HAS8BYTEINT
+    return (OSCTimeTag)timeTag;
+  #else
+    OSCTimeTag tt;
+    tt.seconds = (uint32)(timeTag >> 32);
+    tt.fraction = (uint32)timeTag;
+    return tt;
+  #endif
+}
+
+/**
+ * @brief Initialize the message buffer.
+ * @param bundle 1 to open a bundle
+ * @param timeTag Time tag of the bundle
+ * @return 0 on success
+ */
+static int initBuffer(int bundle, unsigned long long timeTag)
 {
     isBundle = bundle;
 
@@ -102,21 +670,747 @@ int OSC_initMessages(int bundle)
     // open a bundle
     if (isBundle)
     {
-	    if (OSC_openBundle(&osc, OSCTT_Immediately()))
-	        return -1;
+        if (OSC_openBundle(&osc, toTimeTag(timeTag)))
+            return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Send the collected messages to the OSC hosts.
+ * The messages of each host are sent in their own bundles: a single message
+ * is sent as it is, more messages are sent in as many bundles as needed.
+ */
+static void sendQueue(void)
+{
+    char sent[OSC_QUEUE_SIZE];
+    int first;
+    int i;
+
+    sendingQueue = 1;
+    memset(sent, 0, numQueued);
+    for (first = 0; first < numQueued; first++)
+    {
+        const char *host = queue[first].host;
+        int port = queue[first].port;
+        int count = 0;
+
+        if (sent[first])
+            continue;
+
+        for (i = first; i < numQueued; i++)
+        {
+            if (queue[i].host == host && queue[i].port == port)
+                count++;
+        }
+
+        initBuffer(count > 1, OSC_IMMEDIATELY);
+        count = 0;
+        for (i = first; i < numQueued; i++)
+        {
+            PT_OSC_Queued pQueued = &queue[i];
+
+            if (pQueued->host != host || pQueued->port != port)
+                continue;
+            sent[i] = 1;
+
+            if (OSC_appendMessage(pQueued->address, 1, &pQueued->arg) == 0)
+            {
+                count++;
+                continue;
+            }
+
+            // send the bundle if the message does not fit anymore
+            if (count > 0)
+            {
+                OSC_sendMessages(host, port);
+                initBuffer(1, OSC_IMMEDIATELY);
+                count = 0;
+                if (OSC_appendMessage(pQueued->address, 1, &pQueued->arg) == 0)
+                {
+                    count++;
+                    continue;
+                }
+            }
+
+            // larger than a whole packet
+            __atomic_add_fetch(&stats.failed, 1, __ATOMIC_RELAXED);
+        }
+        OSC_sendMessages(host, port);
+    }
+    numQueued = 0;
+    sendingQueue = 0;
+}
+
+/**
+ * @brief Read a big-endian 32-bit integer.
+ * @param p Data
+ * @return Integer
+ */
+static unsigned int readInt32(const char *p)
+{
+    const unsigned char *u = (const unsigned char*)p;
+    return ((unsigned int)u[0] << 24) | ((unsigned int)u[1] << 16) | ((unsigned int)u[2] << 8) | u[3];
+}
+
+/**
+ * @brief Read a big-endian 64-bit integer.
+ * @param p Data
+ * @return Integer
+ */
+static unsigned long long readInt64(const char *p)
+{
+    return ((unsigned long long)readInt32(p) << 32) | readInt32(p + 4);
+}
+
+/**
+ * @brief Check an OSC string padded to 4 bytes.
+ * @param p Start of the string
+ * @param pEnd End of the data
+ * @return Position after the padding or NULL if not terminated
+ */
+static const char* skipString(const char *p, const char *pEnd)
+{
+    const char *pZero = memchr(p, '\0', pEnd - p);
+    if (!pZero)
+        return NULL;
+    return p + (((pZero - p) + 4) & ~3);
+}
+
+/**
+ * @brief Validate and decode an OSC message.
+ * @param p Message
+ * @param len Length of the message
+ * @param callback Function called with the message, can be NULL
+ * @param pObject Pointer passed to the callback
+ * @return 0 if the message is valid, -1 otherwise
+ */
+static int parseMessage(const char *p, int len, OSC_MessageFnc callback, void *pObject)
+{
+    const char *pEnd = p + len;
+    const char *pAddress = p;
+    const char *pTypes;
+    T_OSC_ArgType args[OSC_MAX_ARGS];
+    int numArgs = 0;
+
+    if (*pAddress != '/' || (p = skipString(p, pEnd)) == NULL || p > pEnd)
+        return -1;
+
+    // a message without type tag string has no arguments
+    if (p < pEnd)
+    {
+        pTypes = p;
+        if (*pTypes != ',' || (p = skipString(p, pEnd)) == NULL || p > pEnd)
+            return -1;
+
+        while (*++pTypes)
+        {
+            T_OSC_ArgType arg;
+            switch (*pTypes)
+            {
+                case 'i':
+                case 'f':
+                    if (pEnd - p < 4)
+                        return -1;
+                    if (*pTypes == 'i')
+                    {
+                        arg.type = OSC_INT;
+                        arg.datum.i = (int)readInt32(p);
+                    }
+                    else
+                    {
+                        union { unsigned int u; float f; } conv;
+                        conv.u = readInt32(p);
+                        arg.type = OSC_FLOAT;
+                        arg.datum.f = conv.f;
+                    }
+                    p += 4;
+                    break;
+                case 's':
+                case 'S':
+                    arg.type = OSC_STRING;
+                    arg.datum.s = p;
+                    if ((p = skipString(p, pEnd)) == NULL || p > pEnd)
+                        return -1;
+                    break;
+                case 'h':
+                case 'd':
+                case 't':
+                    if (pEnd - p < 8)
+                        return -1;
+                    if (*pTypes == 'h')
+                    {
+                        arg.type = OSC_INT64;
+                        arg.datum.h = (long long)readInt64(p);
+                    }
+                    else if (*pTypes == 'd')
+                    {
+                        unsigned long long bits = readInt64(p);
+                        arg.type = OSC_DOUBLE;
+                        memcpy(&arg.datum.d, &bits, sizeof(double));
+                    }
+                    else
+                    {
+                        arg.type = OSC_TIME_TAG;
+                        arg.datum.t = readInt64(p);
+                    }
+                    p += 8;
+                    break;
+                case 'b':
+                {
+                    unsigned int size;
+                    if (pEnd - p < 4)
+                        return -1;
+                    size = readInt32(p);
+                    p += 4;
+                    // data padded to 4 bytes
+                    if (size > (unsigned int)(pEnd - p) || ((size + 3) & ~3U) > (unsigned int)(pEnd - p))
+                        return -1;
+                    arg.type = OSC_BLOB;
+                    arg.datum.b.p = p;
+                    arg.datum.b.len = (int)size;
+                    p += (size + 3) & ~3U;
+                    break;
+                }
+                case 'T':
+                    arg.type = OSC_TRUE;
+                    break;
+                case 'F':
+                    arg.type = OSC_FALSE;
+                    break;
+                case 'N':
+                    arg.type = OSC_NIL;
+                    break;
+                default:
+                    return -1;
+            }
+            if (numArgs < OSC_MAX_ARGS)
+                args[numArgs++] = arg;
+        }
+    }
+
+    if (p != pEnd)
+        return -1;
+
+    if (callback)
+        callback(pObject, pAddress, numArgs, args);
+    return 0;
+}
+
+/**
+ * @brief Validate and decode an OSC message or bundle.
+ * @param p Packet
+ * @param len Length of the packet
+ * @param callback Function called for every message, can be NULL
+ * @param pObject Pointer passed to the callback
+ * @param depth Nesting depth of the bundle
+ * @return 0 if the packet is valid, -1 otherwise
+ */
+static int parsePacket(const char *p, int len, OSC_MessageFnc callback, void *pObject, int depth)
+{
+    const char *pEnd = p + len;
+
+    if (len <= 0 || (len & 3) != 0)
+        return -1;
+
+    if (*p != '#')
+        return parseMessage(p, len, callback, pObject);
+
+    // "#bundle", time tag and elements with their size
+    if (len < 16 || memcmp(p, "#bundle", 8) != 0 || depth >= OSC_BUNDLE_DEPTH_MAX)
+        return -1;
+    p += 16;
+    while (p < pEnd)
+    {
+        unsigned int size;
+        if (pEnd - p < 4)
+            return -1;
+        size = readInt32(p);
+        p += 4;
+        if (size > (unsigned int)(pEnd - p) || parsePacket(p, (int)size, callback, pObject, depth + 1))
+            return -1;
+        p += size;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the encoded size of a message.
+ * @param address OSC address
+ * @param numArgs Number of arguments
+ * @param args Arguments
+ * @param typed 1 if the message has a type tag string
+ * @return Size in bytes without the size count of a bundle element
+ */
+static int messageSize(const char *address, int numArgs, PT_OSC_ArgType args, int typed)
+{
+    int size = OSC_effectiveStringLength(address);
+    int i;
+
+    // ",", one tag per argument and the terminating zero, padded
+    if (typed)
+        size += (numArgs + 2 + 3) & ~3;
+
+    for (i = 0; i < numArgs; i++)
+    {
+        switch (args[i].type)
+        {
+            case OSC_INT:
+            case OSC_FLOAT:
+                size += 4;
+                break;
+            case OSC_STRING:
+                size += OSC_effectiveStringLength(args[i].datum.s);
+                // an untyped first string starting with ',' gets another ','
+                if (!typed && i == 0 && args[i].datum.s[0] == ',')
+                    size += 4;
+                break;
+            case OSC_INT64:
+            case OSC_DOUBLE:
+            case OSC_TIME_TAG:
+                size += 8;
+                break;
+            case OSC_BLOB:
+                size += OSC_effectiveBlobLength(args[i].datum.b.len);
+                break;
+            case OSC_TRUE:
+            case OSC_FALSE:
+            case OSC_NIL:
+                break;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Get the value of a hex digit.
+ * @param c Character
+ * @return Value, -1 if c is no hex digit
+ */
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Convert the number of an explicitly typed value to an argument.
+ * Integers are OSC_INT, or OSC_INT64 outside of 32 bits, other numbers
+ * are OSC_DOUBLE.
+ * @param pStr String, e.g. "-12", "0.5" or "1e-3"
+ * @param pArg Argument receiving the number
+ * @return 0 if the string is a number, -1 otherwise
+ */
+static int parseNumber(const char *pStr, PT_OSC_ArgType pArg)
+{
+    const char *p = pStr;
+    int digits = 0;
+    int decimal = 0;
+
+    if (*p == '-')
+        p++;
+
+    // mantissa
+    for (; isdigit(*p) || (*p == '.' && !decimal); p++)
+    {
+        if (*p == '.')
+            decimal = 1;
+        else
+            digits++;
     }
+    if (digits == 0)
+        return -1;
 
+    // exponent
+    if (*p == 'e' || *p == 'E')
+    {
+        decimal = 1;
+        p++;
+        if (*p == '-' || *p == '+')
+            p++;
+        if (!isdigit(*p))
+            return -1;
+        while (isdigit(*p))
+            p++;
+    }
+    if (*p != '\0')
+        return -1;
+
+    if (!decimal)
+    {
+        long long value;
+
+        errno = 0;
+        value = strtoll(pStr, NULL, 10);
+        if (errno == 0 && value >= INT_MIN && value <= INT_MAX)
+        {
+            pArg->type = OSC_INT;
+            pArg->datum.i = (int)value;
+            return 0;
+        }
+        if (errno == 0)
+        {
+            pArg->type = OSC_INT64;
+            pArg->datum.h = value;
+            return 0;
+        }
+        // too large even for 64 bits
+    }
+
+    pArg->type = OSC_DOUBLE;
+    pArg->datum.d = strtod(pStr, NULL);
     return 0;
 }
 
+/**
+ * @brief Convert a string with an explicit type to an argument.
+ * @param tag Type tag, 'i', 'f', 's', 'h', 'd', 't', 'b', 'T', 'F' or 'N'
+ * @param pStr String following the type tag
+ * @param pArg Argument receiving the value
+ * @return 0 on success, -1 if the string does not match the type
+ */
+static int parseTyped(char tag, const char *pStr, PT_OSC_ArgType pArg)
+{
+    T_OSC_ArgType number;
+    int i;
+
+    switch (tag)
+    {
+        case 'i':
+        case 'h':
+            if (parseNumber(pStr, &number) || (number.type != OSC_INT && number.type != OSC_INT64))
+                return -1;
+            if (tag == 'i' && number.type != OSC_INT)
+                return -1;
+            *pArg = number;
+            if (tag == 'h' && number.type == OSC_INT)
+            {
+                pArg->type = OSC_INT64;
+                pArg->datum.h = number.datum.i;
+            }
+            return 0;
+
+        case 'f':
+        case 'd':
+            if (parseNumber(pStr, &number))
+                return -1;
+            pArg->type = tag == 'f' ? OSC_FLOAT : OSC_DOUBLE;
+            if (tag == 'f')
+                pArg->datum.f = (float)strtod(pStr, NULL);
+            else
+                pArg->datum.d = strtod(pStr, NULL);
+            return 0;
+
+        case 't':
+            pArg->datum.t = 0;
+            for (i = 0; i < 16; i++)
+            {
+                if (hexValue(pStr[i]) < 0)
+                    return -1;
+                pArg->datum.t = (pArg->datum.t << 4) | (unsigned long long)hexValue(pStr[i]);
+            }
+            if (pStr[16] != '\0')
+                return -1;
+            pArg->type = OSC_TIME_TAG;
+            return 0;
+
+        case 'b':
+            for (i = 0; pStr[2 * i]; i++)
+            {
+                if (i == (int)sizeof(blobData) || hexValue(pStr[2 * i]) < 0 || hexValue(pStr[2 * i + 1]) < 0)
+                    return -1;
+                blobData[i] = (char)((hexValue(pStr[2 * i]) << 4) | hexValue(pStr[2 * i + 1]));
+            }
+            pArg->type = OSC_BLOB;
+            pArg->datum.b.p = blobData;
+            pArg->datum.b.len = i;
+            return 0;
+
+        case 's':
+            pArg->type = OSC_STRING;
+            pArg->datum.s = pStr;
+            return 0;
+
+        case 'T':
+        case 'F':
+        case 'N':
+            if (*pStr != '\0')
+                return -1;
+            pArg->type = tag == 'T' ? OSC_TRUE : tag == 'F' ? OSC_FALSE : OSC_NIL;
+            return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Prefix a value with its type if OSC_getArgType() would read the
+ * plain text as another type.
+ * @param pArg Argument
+ * @param pBuf Buffer with the plain text
+ * @param size Size of the buffer
+ */
+static void keepType(PT_OSC_ArgType pArg, char *pBuf, int size)
+{
+    int len = (int)strlen(pBuf);
+    T_OSC_ArgType arg = OSC_getArgType(pBuf);
+
+    // a string is read back unchanged only if it has no explicit form
+    if ((arg.type == pArg->type && (arg.type != OSC_STRING || arg.datum.s == pBuf)) || len + 3 > size)
+        return;
+    memmove(pBuf + 2, pBuf, len + 1);
+    pBuf[0] = '#';
+    pBuf[1] = typeTags[pArg->type];
+}
+
+/****************************************************************************/
+
+/**
+ */
+void OSC_init(void)
+{
+  #if OSC_THREAD_EN
+    if (senderRunning)
+        return;
+    __atomic_store_n(&senderRunning, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&sender, NULL, senderThread, NULL) != 0)
+    {
+        // send the packets from the main thread
+        senderRunning = 0;
+        printf("OSC sender thread not started\n");
+    }
+  #endif
+}
+
+/**
+ */
+void OSC_refresh(void)
+{
+  #if OSC_TCP_EN
+    // connect the lost TCP destinations again
+    OSCTCP_refresh();
+  #endif
+  #if OSC_THREAD_EN
+    // the sender thread owns the destinations
+    if (senderRunning)
+        return;
+  #endif
+    refreshTransports();
+}
+
+/**
+ */
+void OSC_deinit(void)
+{
+    int i;
+
+  #if OSC_THREAD_EN
+    if (senderRunning)
+    {
+        // the thread sends the remaining packets before it stops
+        pthread_mutex_lock(&senderMutex);
+        __atomic_store_n(&senderRunning, 0, __ATOMIC_RELEASE);
+        pthread_cond_signal(&senderWakeUp);
+        pthread_mutex_unlock(&senderMutex);
+        pthread_join(sender, NULL);
+    }
+  #endif
+
+    for (i = 0; i < OSC_MAX_DESTINATIONS; i++)
+        closeTransport(&transports[i]);
+
+  #if OSC_TCP_EN
+    OSCTCP_deinit();
+  #endif
+}
+
+/**
+ */
+void OSC_getStats(PT_OSC_Stats pStats)
+{
+    pStats->sent = __atomic_load_n(&stats.sent, __ATOMIC_RELAXED);
+    pStats->failed = __atomic_load_n(&stats.failed, __ATOMIC_RELAXED);
+    pStats->dropped = __atomic_load_n(&stats.dropped, __ATOMIC_RELAXED);
+    pStats->syscalls = __atomic_load_n(&stats.syscalls, __ATOMIC_RELAXED);
+    pStats->totalLatencyUs = __atomic_load_n(&stats.totalLatencyUs, __ATOMIC_RELAXED);
+    pStats->maxLatencyUs = __atomic_load_n(&stats.maxLatencyUs, __ATOMIC_RELAXED);
+}
+
+/**
+ */
+int OSC_initMessages(int bundle)
+{
+    // keep the order of the values
+    OSC_flush(1);
+
+    return initBuffer(bundle, OSC_IMMEDIATELY);
+}
+
+/**
+ */
+int OSC_initBundle(unsigned long long timeTag)
+{
+    // keep the order of the values
+    OSC_flush(1);
+
+    return initBuffer(1, timeTag);
+}
+
+/**
+ */
+void OSC_queueMessage(const char *host, int port, const char *address, PT_OSC_ArgType pArg)
+{
+    unsigned int hash;
+    PT_OSC_Queued pQueued = NULL;
+    size_t len = strlen(address);
+    int i;
+
+    // addresses too long to be collected are sent at once
+    if (len >= OSC_ADDRESS_MAX)
+    {
+        OSC_initMessages(0);
+        if (OSC_appendMessage(address, 1, pArg) == 0)
+            OSC_sendMessages(host, port);
+        else
+            __atomic_add_fetch(&stats.failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // a newer value replaces the collected one
+    hash = str_hash(address, len);
+    for (i = 0; i < numQueued; i++)
+    {
+        if (queue[i].hash == hash && strcmp(queue[i].address, address) == 0)
+        {
+            pQueued = &queue[i];
+            break;
+        }
+    }
+
+    if (!pQueued)
+    {
+        if (numQueued == OSC_QUEUE_SIZE)
+            OSC_flush(1);
+        if (numQueued == 0)
+            queuedUs = SYS_getMicroseconds();
+        pQueued = &queue[numQueued++];
+        pQueued->hash = hash;
+        memcpy(pQueued->address, address, len + 1);
+    }
+
+    pQueued->host = host;
+    pQueued->port = port;
+    pQueued->arg = *pArg;
+    if (pArg->type == OSC_STRING)
+    {
+        strncpy(pQueued->value, pArg->datum.s, DP_VALUE_LENGTH_MAX - 1);
+        pQueued->value[DP_VALUE_LENGTH_MAX - 1] = '\0';
+        pQueued->arg.datum.s = pQueued->value;
+    }
+    else if (pArg->type == OSC_BLOB)
+    {
+        memcpy(pQueued->value, pArg->datum.b.p, pArg->datum.b.len);
+        pQueued->arg.datum.b.p = pQueued->value;
+    }
+}
+
+/**
+ */
+void OSC_flush(int force)
+{
+    if (numQueued == 0)
+        return;
+    if (!force && SYS_getMicroseconds() - queuedUs < (unsigned long long)app.osc_window * 1000)
+        return;
+    sendQueue();
+}
+
+/**
+ */
+int OSC_getTimeout(int timeout)
+{
+    unsigned long long elapsed;
+    unsigned long long window = (unsigned long long)app.osc_window * 1000;
+
+    if (numQueued == 0)
+        return timeout;
+
+    elapsed = SYS_getMicroseconds() - queuedUs;
+    if (elapsed >= window)
+        return 0;
+
+    // round up, the messages are sent after the window
+    window = (window - elapsed + 999) / 1000;
+    return window < (unsigned long long)timeout ? (int)window : timeout;
+}
+
+/**
+ */
+unsigned long long OSC_getTimeTag(double delay)
+{
+    unsigned long long seconds;
+    unsigned long long fraction;
+  #ifdef _WIN32
+    FILETIME ft;
+    unsigned long long ticks;
+
+    // 100 ns ticks since 1601, NTP time starts in 1900
+    GetSystemTimeAsFileTime(&ft);
+    ticks = ((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    seconds = ticks / 10000000ULL - 9435484800ULL;
+    fraction = ((ticks % 10000000ULL) << 32) / 10000000ULL;
+  #else
+    struct timespec ts;
+
+    // seconds since 1970, NTP time starts in 1900
+    clock_gettime(CLOCK_REALTIME, &ts);
+    seconds = (unsigned long long)ts.tv_sec + 2208988800ULL;
+    fraction = ((unsigned long long)ts.tv_nsec << 32) / 1000000000ULL;
+  #endif
+    if (delay < 0.0)
+        delay = 0.0;
+    return ((seconds << 32) | fraction) + (unsigned long long)(delay * 4294967296.0);
+}
+
 /**
  */
 int OSC_appendMessage(const char *address, int numArgs, PT_OSC_ArgType args)
 {
+    char types[OSC_MAX_ARGS + 2];
+    int typed = 0;
     int i;
 
+    // the types of OSC 1.1 need a type tag string
+    for (i = 0; i < numArgs; i++)
+    {
+        if (args[i].type > OSC_STRING)
+            typed = 1;
+    }
+
+    if (typed && numArgs > OSC_MAX_ARGS)
+        return -1;
+
+    // nothing is written if the message does not fit, a bundle element
+    // needs its size count too
+    if (messageSize(address, numArgs, args, typed) + (isBundle ? 4 : 0) > OSC_freeSpaceInBuffer(&osc))
+        return -1;
+
     // write the address of the message
-    if (OSC_writeAddress(&osc, address))
+    if (typed)
+    {
+        types[0] = ',';
+        for (i = 0; i < numArgs; i++)
+            types[i + 1] = typeTags[args[i].type];
+        types[numArgs + 1] = '\0';
+        if (OSC_writeAddressAndTypes(&osc, address, types))
+            return -1;
+    }
+    else if (OSC_writeAddress(&osc, address))
         return -1;
 
     // write arguments
@@ -138,6 +1432,33 @@ int OSC_appendMessage(const char *address, int numArgs, PT_OSC_ArgType args)
                 if (OSC_writeStringArg(&osc, args[i].datum.s) != 0)
                     return -1;
                 break;
+
+            case OSC_INT64:
+                if (OSC_writeInt64Arg(&osc, args[i].datum.h) != 0)
+                    return -1;
+                break;
+
+            case OSC_DOUBLE:
+                if (OSC_writeDoubleArg(&osc, args[i].datum.d) != 0)
+                    return -1;
+                break;
+
+            case OSC_BLOB:
+                if (OSC_writeBlobArg(&osc, args[i].datum.b.p, args[i].datum.b.len) != 0)
+                    return -1;
+                break;
+
+            case OSC_TIME_TAG:
+                if (OSC_writeTimeTagArg(&osc, toTimeTag(args[i].datum.t)) != 0)
+                    return -1;
+                break;
+
+            case OSC_TRUE:
+            case OSC_FALSE:
+            case OSC_NIL:
+                if (OSC_writeNoDataArg(&osc, typeTags[args[i].type]) != 0)
+                    return -1;
+                break;
         }
     }
 
@@ -170,7 +1491,98 @@ int OSC_sendMessages(const char *host, int port)
         return -1;
 
     // send messages
-    return sendUDP(host, port, OSC_getPacket(&osc), OSC_packetSize(&osc));
+    return sendPacket(host, port, OSC_getPacket(&osc), OSC_packetSize(&osc));
+}
+
+/**
+ */
+int OSC_sendPacket(const char *host, int port, const char *pPacket, int len)
+{
+    // keep the order of the values
+    OSC_flush(1);
+
+    return sendPacket(host, port, pPacket, len);
+}
+
+/**
+ */
+int OSC_parsePacket(const char *pPacket, int len, OSC_MessageFnc callback, void *pObject)
+{
+    return parsePacket(pPacket, len, callback, pObject, 0);
+}
+
+/**
+ */
+void OSC_argToString(PT_OSC_ArgType pArg, char *pBuf, int size)
+{
+    int precision;
+    int i;
+
+    switch (pArg->type)
+    {
+        case OSC_INT:
+            snprintf(pBuf, size, "%d", pArg->datum.i);
+            break;
+
+        case OSC_FLOAT:
+            for (precision = 1; precision < 9; precision++)
+            {
+                snprintf(pBuf, size, "%.*g", precision, pArg->datum.f);
+                if ((float)strtod(pBuf, NULL) == pArg->datum.f)
+                    break;
+            }
+            if (precision == 9)
+                snprintf(pBuf, size, "%.9g", pArg->datum.f);
+            // keep the type for OSC_getArgType()
+            if (!strpbrk(pBuf, ".ein") && (int)strlen(pBuf) + 2 < size)
+                strcat(pBuf, ".0");
+            keepType(pArg, pBuf, size);
+            break;
+
+        case OSC_STRING:
+            snprintf(pBuf, size, "%s", pArg->datum.s);
+            keepType(pArg, pBuf, size);
+            break;
+
+        case OSC_INT64:
+            snprintf(pBuf, size, "%lld", pArg->datum.h);
+            keepType(pArg, pBuf, size);
+            break;
+
+        case OSC_DOUBLE:
+            for (precision = 1; precision < 17; precision++)
+            {
+                snprintf(pBuf, size, "%.*g", precision, pArg->datum.d);
+                if (strtod(pBuf, NULL) == pArg->datum.d)
+                    break;
+            }
+            if (precision == 17)
+                snprintf(pBuf, size, "%.17g", pArg->datum.d);
+            keepType(pArg, pBuf, size);
+            break;
+
+        case OSC_BLOB:
+            snprintf(pBuf, size, "#b");
+            for (i = 0; i < pArg->datum.b.len && 2 * i + 5 <= size; i++)
+                sprintf(pBuf + 2 + 2 * i, "%02x", (unsigned char)pArg->datum.b.p[i]);
+            break;
+
+        case OSC_TRUE:
+            snprintf(pBuf, size, "#T");
+            break;
+
+        case OSC_FALSE:
+            snprintf(pBuf, size, "#F");
+            break;
+
+        case OSC_NIL:
+            snprintf(pBuf, size, "#N");
+            break;
+
+        case OSC_TIME_TAG:
+            snprintf(pBuf, size, "#t%016llx", pArg->datum.t);
+            break;
+    }
 }
 
 /**
@@ -180,6 +1592,10 @@ T_OSC_ArgType OSC_getArgType(const char *pStr)
     const char *p = pStr;
     T_OSC_ArgType arg;
 
+    // the other types need their explicit form
+    if (pStr[0] == '#' && pStr[1] && parseTyped(pStr[1], pStr + 2, &arg) == 0)
+        return arg;
+
     if (*p == '-')
         p++;
 
@@ -43,28 +43,154 @@ typedef struct t_OSC_ArgType
     enum {
         OSC_INT,            /**< integer */
         OSC_FLOAT,          /**< float */
-        OSC_STRING          /**< string */
+        OSC_STRING,         /**< string */
+        OSC_INT64,          /**< 64 bit integer */
+        OSC_DOUBLE,         /**< double */
+        OSC_BLOB,           /**< blob */
+        OSC_TRUE,           /**< true, no value */
+        OSC_FALSE,          /**< false, no value */
+        OSC_NIL,            /**< nil, no value */
+        OSC_TIME_TAG        /**< time tag */
     } type;                 /**< argument type */
     union {
         int i;              /**< integer value */
         float f;            /**< float value */
         const char *s;      /**< string value (pointer) */
+        long long h;        /**< 64 bit integer value */
+        double d;           /**< double value */
+        unsigned long long t; /**< time tag value in NTP format */
+        struct {
+            const char *p;  /**< data (pointer) */
+            int len;        /**< length of the data */
+        } b;                /**< blob value */
     } datum;                /**< argument value */
 } T_OSC_ArgType, *PT_OSC_ArgType;
 
+/** @brief Statistics of the packets sent to the OSC hosts */
+typedef struct t_OSC_Stats
+{
+    unsigned long sent;                 /**< number of packets sent */
+    unsigned long failed;               /**< number of packets which could not be sent */
+    unsigned long dropped;              /**< number of packets dropped because the ring of the sender thread was full */
+    unsigned long syscalls;             /**< number of system calls sending the packets */
+    unsigned long long totalLatencyUs;  /**< time from queuing to sending of all packets in microseconds (sender thread) */
+    unsigned long long maxLatencyUs;    /**< longest time from queuing to sending in microseconds (sender thread) */
+} T_OSC_Stats, *PT_OSC_Stats;
+
+/** Time tag of a bundle applied when it is received */
+#define OSC_IMMEDIATELY             1ULL
+
+/** Maximal number of arguments of a decoded message passed to the callback */
+#define OSC_MAX_ARGS                16
+
+/**
+ * @brief Callback for a message decoded by OSC_parsePacket().
+ * The address and string arguments point into the packet.
+ * @param pObject Pointer given to OSC_parsePacket()
+ * @param pAddress OSC address
+ * @param numArgs Number of arguments (at most OSC_MAX_ARGS)
+ * @param pArgs Arguments
+ */
+typedef void (*OSC_MessageFnc)(void *pObject, const char *pAddress, int numArgs, PT_OSC_ArgType pArgs);
+
+/**
+ * @brief Initialize the OSC module.
+ * With OSC_THREAD_EN the sender thread is started: packets are then queued
+ * in a lock-free ring and sent by this thread, so a slow send or name
+ * resolution does not block the web-server. The thread is pinned to the CPU
+ * app.osc_thread_cpu (if >= 0) and runs with the SCHED_FIFO priority
+ * app.osc_thread_priority (if > 0). If the ring is full the packet is dropped
+ * and counted (see OSC_getStats()).
+ */
+void OSC_init(void);
+
+/**
+ * @brief Resolve the addresses of the OSC destinations again.
+ * Every destination keeps a UDP socket connected to its address, so sending
+ * a packet does not wait for a name resolution. Call this function
+ * periodically from the main loop, the addresses are resolved every
+ * OSC_RESOLVE_INTERVAL seconds. Lost TCP connections are opened again.
+ */
+void OSC_refresh(void);
+
+/**
+ * @brief De-initialize the OSC module.
+ * The sender thread sends the queued packets and is stopped, then the
+ * sockets of all destinations are closed. Packets still queued for TCP
+ * destinations are dropped.
+ */
+void OSC_deinit(void);
+
+/**
+ * @brief Get the statistics of the packets sent to the OSC hosts.
+ * @param pStats Structure receiving the statistics
+ */
+void OSC_getStats(PT_OSC_Stats pStats);
+
 /**
  * @brief Initialize a new message buffer.
+ * The collected messages are sent first (see OSC_queueMessage()).
  * @param bundle 1 if more than one messages will be appended
  * @return 0 on success
  */
 int OSC_initMessages(int bundle);
 
+/**
+ * @brief Initialize a new bundle with a time tag.
+ * The receiver applies all messages of the bundle at the time of the tag.
+ * @param timeTag Time tag in NTP format (seconds since 1900 in the upper
+ *        32 bits, fraction in the lower 32 bits), OSC_IMMEDIATELY to apply
+ *        the messages when they are received
+ * @return 0 on success
+ */
+int OSC_initBundle(unsigned long long timeTag);
+
+/**
+ * @brief Compute the time tag of a point in time.
+ * @param delay Seconds from now
+ * @return Time tag in NTP format
+ */
+unsigned long long OSC_getTimeTag(double delay);
+
+/**
+ * @brief Queue a message with one argument to an OSC host.
+ * The messages are collected during app.osc_window milliseconds, then sent
+ * in as few bundles per host as possible (see OSC_flush()). A message to an
+ * address already collected replaces it, so only the last value is sent.
+ * @param host Host where the message should be sent, the string must stay
+ *             valid until the message is sent
+ * @param port Port number of the host
+ * @param address OSC address
+ * @param pArg Argument, a string is copied
+ */
+void OSC_queueMessage(const char *host, int port, const char *address, PT_OSC_ArgType pArg);
+
+/**
+ * @brief Send the collected messages to the OSC hosts.
+ * Call this function after every iteration of the main loop. The functions
+ * building or sending other packets send the collected messages first, so
+ * the order of the values is kept.
+ * @param force 1 to send them at once, 0 to send them if the window elapsed
+ */
+void OSC_flush(int force);
+
+/**
+ * @brief Get the time the main loop may wait for events.
+ * @param timeout Maximal time in milliseconds
+ * @return Time in milliseconds until the collected messages are due, at
+ *         most timeout
+ */
+int OSC_getTimeout(int timeout);
+
 /**
  * @brief Append a message to the bundle.
+ * Messages with integer, float and string arguments only are written
+ * without type tag string, the other types need one.
  * @param address OSC address
  * @param numArgs Number of arguments
  * @param args Argument list
- * @return 0 on success
+ * @return 0 on success, -1 if the message does not fit into the bundle
+ *         (nothing is written then)
  */
 int OSC_appendMessage(const char *address, int numArgs, PT_OSC_ArgType args);
 
@@ -72,12 +198,62 @@ int OSC_appendMessage(const char *address, int numArgs, PT_OSC_ArgType args);
  * @brief Send the message bundle.
  * @param host Host where OSC messages should be sent
  * @param port Port number of the host
- * @return 0 on success
+ * @return 0 on success (queued to the sender thread with OSC_THREAD_EN)
  */
 int OSC_sendMessages(const char *host, int port);
 
+/**
+ * @brief Send a packet which is already encoded.
+ * @param host Host where the packet should be sent, OSCTCP_SCHEME "host"
+ * sends it over TCP (see osc_tcp.h)
+ * @param port Port number of the host
+ * @param pPacket OSC message or bundle
+ * @param len Length of the packet
+ * @return 0 on success
+ */
+int OSC_sendPacket(const char *host, int port, const char *pPacket, int len);
+
+/**
+ * @brief Validate and decode an OSC message or bundle.
+ * Bundles may be nested, their time tags are ignored. The argument types
+ * 'i', 'f', 's', 'S', 'h', 'd', 't', 'b', 'T', 'F' and 'N' are supported,
+ * any other type makes the packet invalid. Strings and blobs point into the
+ * packet. The callback is called for every message in the order of the
+ * packet with at most OSC_MAX_ARGS arguments.
+ * @param pPacket OSC message or bundle
+ * @param len Length of the packet
+ * @param callback Function called for every message, NULL to only validate
+ * @param pObject Pointer passed to the callback
+ * @return 0 if the packet is valid, -1 otherwise
+ */
+int OSC_parsePacket(const char *pPacket, int len, OSC_MessageFnc callback, void *pObject);
+
+/**
+ * @brief Convert an argument structure to a string.
+ * This is the inverse of OSC_getArgType(), floats and doubles are printed
+ * with the fewest digits which read back to the same value. A value whose
+ * plain text would be read back as another type is written in its explicit
+ * form, e.g. "#h5", "#d0.5", or "#s5" and "#s#T" for the strings "5" and
+ * "#T".
+ * @param pArg Argument
+ * @param pBuf Buffer receiving the string
+ * @param size Size of the buffer
+ */
+void OSC_argToString(PT_OSC_ArgType pArg, char *pBuf, int size);
+
 /**
  * @brief Convert an argument string to an argument structure.
+ * The data-pool keeps the values as text, their type is chosen here:
+ * - an integer (e.g. "-12") is an OSC_INT
+ * - a decimal number (e.g. "0.5") is an OSC_FLOAT
+ * - "#i", "#f", "#h" and "#d" followed by a number (e.g. "#d0.1" or
+ *   "#h5") are an OSC_INT, OSC_FLOAT, OSC_INT64 or OSC_DOUBLE
+ * - "#t" followed by 16 hex digits is an OSC_TIME_TAG (NTP format)
+ * - "#b" followed by pairs of hex digits is an OSC_BLOB, its data is
+ *   decoded into a static buffer valid until the next call
+ * - "#T", "#F" and "#N" are OSC_TRUE, OSC_FALSE and OSC_NIL
+ * - "#s" followed by any text is an OSC_STRING of this text (e.g. "#s5")
+ * - anything else is an OSC_STRING, including "true" or "1e-3"
  * @param pStr String containing the parameter
  * @return A structure with the converted argument.
  */
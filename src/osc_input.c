@@ -0,0 +1,253 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "osc_input.h"
+
+#if OSCIN_EN
+
+#include <stdio.h>
+#include <string.h>
+#include "datapool.h"
+#include "osc.h"
+#include "osc_route.h"
+#if OSC_TCP_EN
+  #include "osc_tcp.h"
+#endif
+#ifdef _WIN32
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#else
+  #include <sys/socket.h>
+  #include <netinet/in.h>
+  #include <arpa/inet.h>
+  #include <netdb.h>
+#endif
+
+/****************************************************************************/
+
+/** Maximal number of addresses the packets of a port are accepted from */
+#define OSCIN_MAX_SENDERS           16
+
+/** Buffer size for a numeric IPv4 or IPv6 address */
+#define OSCIN_ADDRESS_SIZE          48
+
+/** @brief Source of the packets received on a port */
+typedef struct t_OSCIN_Source
+{
+    int hub;                                                /**< set for the hub port */
+    int numSenders;                                         /**< number of allowed senders */
+    char senders[OSCIN_MAX_SENDERS][OSCIN_ADDRESS_SIZE];    /**< numeric addresses of the allowed senders */
+} T_OSCIN_Source, *PT_OSCIN_Source;
+
+/****************************************************************************/
+
+/** Statistics of the received packets */
+static T_OSCIN_Stats stats;
+
+/** Source of the packets received on the feedback port */
+static T_OSCIN_Source fromHost;
+
+/** Source of the packets received on the hub port */
+static T_OSCIN_Source fromHub;
+
+/****************************************************************************/
+
+/**
+ * @brief Write the first argument of a received message to the data-pool.
+ * Values of the OSC host are not routed back to it, values of controllers
+ * are routed like the values of web clients.
+ * @param pObject Source of the message (fromHost or fromHub)
+ * @param pAddress OSC address
+ * @param numArgs Number of arguments
+ * @param pArgs Arguments
+ */
+static void updateMessage(void *pObject, const char *pAddress, int numArgs, PT_OSC_ArgType pArgs)
+{
+    char value[DP_VALUE_LENGTH_MAX];
+
+    if (numArgs == 0)
+        return;
+
+    if (((PT_OSCIN_Source)pObject)->hub)
+    {
+        OSC_argToString(&pArgs[0], value, DP_VALUE_LENGTH_MAX);
+        DP_setValue(pAddress, value);
+        stats.forwarded++;
+    }
+    else if (OSCROUTE_find(pAddress))
+    {
+        OSC_argToString(&pArgs[0], value, DP_VALUE_LENGTH_MAX);
+        DP_updateValue(pAddress, value);
+        stats.messages++;
+    }
+}
+
+/**
+ * @brief Add the addresses of a host to the allowed senders of a source.
+ * The host is resolved once, when the module is initialized.
+ * @param pSource Source
+ * @param pHost Host name or IP, OSCTCP_SCHEME is skipped
+ */
+static void addSenders(PT_OSCIN_Source pSource, const char *pHost)
+{
+    struct addrinfo hints;
+    struct addrinfo *pList;
+    struct addrinfo *pInfo;
+
+  #if OSC_TCP_EN
+    if (strncmp(pHost, OSCTCP_SCHEME, sizeof(OSCTCP_SCHEME) - 1) == 0)
+        pHost += sizeof(OSCTCP_SCHEME) - 1;
+  #endif
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(pHost, NULL, &hints, &pList) != 0)
+    {
+        printf("Cannot resolve OSC sender \"%s\"\n", pHost);
+        return;
+    }
+
+    for (pInfo = pList; pInfo && pSource->numSenders < OSCIN_MAX_SENDERS; pInfo = pInfo->ai_next)
+    {
+        char *pSender = pSource->senders[pSource->numSenders];
+        const void *pAddr = pInfo->ai_family == AF_INET ?
+                            (const void*)&((const struct sockaddr_in*)pInfo->ai_addr)->sin_addr :
+                            (const void*)&((const struct sockaddr_in6*)pInfo->ai_addr)->sin6_addr;
+        int i;
+
+        if (!inet_ntop(pInfo->ai_family, pAddr, pSender, OSCIN_ADDRESS_SIZE))
+            continue;
+        for (i = 0; i < pSource->numSenders && strcmp(pSource->senders[i], pSender); i++)
+            ;
+        if (i == pSource->numSenders)
+            pSource->numSenders++;
+    }
+    freeaddrinfo(pList);
+}
+
+/**
+ * @brief Check if packets of an address are accepted by a source.
+ * @param pSource Source
+ * @param pRemoteIp Numeric address of the sender
+ * @return 1 if the sender is allowed, else 0
+ */
+static int isSender(PT_OSCIN_Source pSource, const char *pRemoteIp)
+{
+    int i;
+    for (i = 0; i < pSource->numSenders; i++)
+    {
+        if (strcmp(pSource->senders[i], pRemoteIp) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Handle a packet received from the OSC host or a controller.
+ * Packets are only accepted from the OSC hosts on the feedback port and
+ * from the allowed controllers on the hub port.
+ * @param pParam Source of the packet (fromHost or fromHub)
+ * @param pBuffer Packet
+ * @param len Length of the packet
+ * @param pRemoteIp Numeric address of the sender
+ */
+static void receivePacket(void *pParam, const char *pBuffer, int len, const char *pRemoteIp)
+{
+    PT_OSCIN_Source pSource = (PT_OSCIN_Source)pParam;
+
+    if (!isSender(pSource, pRemoteIp))
+    {
+        stats.dropped++;
+        return;
+    }
+
+    // validate the whole packet before anything is written
+    if (OSC_parsePacket(pBuffer, len, NULL, NULL))
+    {
+        stats.rejected++;
+        return;
+    }
+
+    stats.packets++;
+    OSC_parsePacket(pBuffer, len, updateMessage, pParam);
+}
+
+/**
+ * @brief Bind a UDP port receiving OSC packets.
+ * @param server Web-server
+ * @param port UDP port, 0 to do nothing
+ * @param pSource Source of the packets (fromHost or fromHub)
+ * @return 0 on success, -1 if the port cannot be bound
+ */
+static int bindPort(struct mg_server *server, int port, PT_OSCIN_Source pSource)
+{
+    char address[16];
+
+    if (port == 0)
+        return 0;
+
+    sprintf(address, "%d", port);
+    return mg_bind_udp(server, address, receivePacket, pSource);
+}
+
+/****************************************************************************/
+
+/**
+ */
+int OSCIN_init(struct mg_server *server)
+{
+    const T_OSCROUTE_Destination *pDestination;
+    int ret, i;
+
+    memset(&stats, 0, sizeof(T_OSCIN_Stats));
+
+    // the feedback port accepts the packets of the OSC hosts only
+    memset(&fromHost, 0, sizeof(T_OSCIN_Source));
+    if (app.osc_listen_port)
+    {
+        for (i = 0; (pDestination = OSCROUTE_get(i)) != NULL; i++)
+            addSenders(&fromHost, pDestination->host);
+    }
+
+    // the hub port accepts the packets of the allowed controllers only
+    memset(&fromHub, 0, sizeof(T_OSCIN_Source));
+    fromHub.hub = 1;
+    if (app.osc_hub_port)
+    {
+        char allow[CONFIG_BUFFER_SIZE];
+        char *pHost;
+
+        strcpy(allow, app.osc_hub_allow[0] ? app.osc_hub_allow : "localhost");
+        for (pHost = strtok(allow, " \t,"); pHost; pHost = strtok(NULL, " \t,"))
+            addSenders(&fromHub, pHost);
+    }
+
+    ret = bindPort(server, app.osc_listen_port, &fromHost);
+    if (bindPort(server, app.osc_hub_port, &fromHub))
+        ret = -1;
+    return ret;
+}
+
+/**
+ */
+void OSCIN_getStats(PT_OSCIN_Stats pStats)
+{
+    *pStats = stats;
+}
+
+#endif // OSCIN_EN
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file osc_input.h
+ *  @brief Listeners for the OSC messages of the OSC host and of controllers.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _OSC_INPUT_H_
+#define _OSC_INPUT_H_
+
+#include "release.h"
+#include "mongoose.h"
+
+/**
+ * @defgroup OSCIN OSC input
+ * @brief Data-pool updates from the OSC host and from OSC controllers.
+ *
+ * <b>Feedback</b>
+ *
+ * The OSC host (e.g. a synthesizer using MIDI learn or automation) sends
+ * its parameter changes as OSC messages or bundles to the UDP port
+ * app.osc_listen_port. The listener is bound to the event loop of the
+ * web-server and decodes the packets in place. Only packets sent from an
+ * address of an OSC host (osc_host and osc_route, resolved once when the
+ * module is initialized) are accepted, others are dropped. Feedback of
+ * destinations given as multicast or broadcast address is not accepted.
+ *
+ * The first argument of every message whose address is routed to an OSC
+ * host (see OSCROUTE_find()) is written to the data-pool variable of the
+ * same name with DP_updateValue(): web clients are notified, the value is
+ * not sent back to the OSC host. Invalid packets are dropped as a whole.
+ *
+ * <b>Hub</b>
+ *
+ * Other controllers (hardware surfaces, tablet apps) send their OSC messages
+ * to the UDP port app.osc_hub_port. The first argument of every message is
+ * written with DP_setValue() as if it came from a web client: web clients
+ * are notified and the routed values are forwarded to their OSC host through
+ * the output coalescer (see OSC_queueMessage()), so the message rate seen by
+ * the host stays bounded. Time tags of bundles are
+ * ignored, the values are applied at once. Only packets sent from an address
+ * of app.osc_hub_allow (the local host if empty) are accepted.
+ * @{
+ */
+
+/** @brief Statistics of the packets received from the OSC host and the controllers */
+typedef struct t_OSCIN_Stats
+{
+    unsigned long packets;      /**< number of valid packets received */
+    unsigned long messages;     /**< number of messages of the OSC host written to the data-pool */
+    unsigned long forwarded;    /**< number of messages of controllers written to the data-pool */
+    unsigned long rejected;     /**< number of invalid packets dropped */
+    unsigned long dropped;      /**< number of packets of senders not allowed dropped */
+} T_OSCIN_Stats, *PT_OSCIN_Stats;
+
+/**
+ * @brief Initialize the OSC input module.
+ * Binds the UDP ports app.osc_listen_port and app.osc_hub_port to the event
+ * loop of the web-server, a port of 0 is not bound.
+ * @param server Web-server
+ * @return 0 on success, -1 if a port cannot be bound
+ */
+int OSCIN_init(struct mg_server *server);
+
+/**
+ * @brief Get the statistics of the packets received from the OSC host and
+ * the controllers.
+ * @param pStats Structure receiving the statistics
+ */
+void OSCIN_getStats(PT_OSCIN_Stats pStats);
+
+/** @} OSCIN */
+
+#endif // _OSC_INPUT_H_
@@ -0,0 +1,128 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "osc_route.h"
+
+#if OSC_EN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "radix.h"
+#include "utils.h"
+
+/****************************************************************************/
+
+/** Maximal number of destinations */
+#define OSCROUTE_MAX_DESTINATIONS   (1 + CONFIG_OSC_ROUTES_MAX)
+
+/****************************************************************************/
+
+/** Root of the radix trie of the prefixes, its label is empty */
+static T_RadixNode root;
+
+/** Destinations */
+static T_OSCROUTE_Destination destinations[OSCROUTE_MAX_DESTINATIONS];
+
+/** Number of destinations */
+static int numDestinations = 0;
+
+/****************************************************************************/
+
+/**
+ * @brief Add a destination and insert its prefix into the radix trie.
+ * A destination with the same prefix as a previous one replaces it in its
+ * slot.
+ * @param pPrefix Prefix of the routed variables
+ * @param pHost OSC host name or IP
+ * @param port Port number of the OSC host
+ * @return 0 on success, -1 if too many destinations or out of memory
+ */
+static int addDestination(const char *pPrefix, const char *pHost, int port)
+{
+    PT_OSCROUTE_Destination pDestination;
+    PT_RadixNode pNode;
+
+    pNode = RADIX_insert(&root, pPrefix);
+    if (!pNode)
+        return -1;
+
+    pDestination = (PT_OSCROUTE_Destination)pNode->pValue;
+    if (!pDestination)
+    {
+        if (numDestinations == OSCROUTE_MAX_DESTINATIONS)
+            return -1;
+        pDestination = &destinations[numDestinations++];
+        pNode->pValue = pDestination;
+    }
+    snprintf(pDestination->prefix, CONFIG_BUFFER_SIZE, "%s", pPrefix);
+    snprintf(pDestination->host, CONFIG_BUFFER_SIZE, "%s", pHost);
+    pDestination->port = port;
+    return 0;
+}
+
+/****************************************************************************/
+
+/**
+ */
+void OSCROUTE_init(void)
+{
+    int i;
+
+    OSCROUTE_deinit();
+
+    addDestination(app.osc_prefix, app.osc_host, app.osc_port);
+    for (i = 0; i < app.osc_num_routes; i++)
+    {
+        char prefix[CONFIG_BUFFER_SIZE];
+        char host[CONFIG_BUFFER_SIZE];
+        int port;
+
+        if (sscanf(app.osc_routes[i], "%127s %127s %d", prefix, host, &port) != 3 ||
+            port <= 0 || port > 65535 || addDestination(prefix, host, port))
+        {
+            printf("Invalid OSC route \"%s\"\n", app.osc_routes[i]);
+        }
+    }
+}
+
+/**
+ */
+void OSCROUTE_deinit(void)
+{
+    RADIX_free(&root);
+    memset(destinations, 0, sizeof(destinations));
+    numDestinations = 0;
+}
+
+/**
+ */
+const T_OSCROUTE_Destination* OSCROUTE_find(const char *pAddress)
+{
+    return (const T_OSCROUTE_Destination*)RADIX_findPrefix(&root, pAddress);
+}
+
+/**
+ */
+const T_OSCROUTE_Destination* OSCROUTE_get(int index)
+{
+    if (index < 0 || index >= numDestinations)
+        return NULL;
+    return &destinations[index];
+}
+
+#endif // OSC_EN
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file osc_route.h
+ *  @brief Routing of the data-pool variables to the OSC hosts.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _OSC_ROUTE_H_
+#define _OSC_ROUTE_H_
+
+#include "release.h"
+
+/**
+ * @defgroup OSCROUTE OSC routing
+ * @brief Prefix-based routing of the data-pool variables to the OSC hosts.
+ *
+ * Every OSC host (destination) receives the variables starting with its
+ * prefix. The first destination is set with osc_host, osc_port and
+ * osc_prefix, further destinations with osc_route lines ("prefix host port")
+ * in the configuration file:
+ *
+ *  <PRE>
+ *  osc_route = "/lights/ 192.168.1.20 7000"
+ *  osc_route = "/video/ video-server.local 9000"
+ *  </PRE>
+ *
+ * The prefixes are stored in a radix trie (see @ref RADIX) when the module
+ * is initialized, a prefix given twice keeps the last destination.
+ * A variable is routed to the destination with the longest matching prefix
+ * only. Each destination has its own socket (see OSC_sendPacket()) and the
+ * collected messages are sent in separate bundles per destination (see
+ * OSC_queueMessage()).
+ * @{
+ */
+
+/** @brief Destination of the OSC messages */
+typedef struct t_OSCROUTE_Destination
+{
+    char prefix[CONFIG_BUFFER_SIZE];    /**< prefix of the routed variables */
+    char host[CONFIG_BUFFER_SIZE];      /**< OSC host name or IP */
+    int port;                           /**< port number of the OSC host */
+} T_OSCROUTE_Destination, *PT_OSCROUTE_Destination;
+
+/**
+ * @brief Initialize the OSC routing module.
+ * The destinations are read from the application configuration and their
+ * prefixes are inserted into the trie. Invalid osc_route lines are reported
+ * and ignored.
+ */
+void OSCROUTE_init(void);
+
+/**
+ * @brief De-initialize the OSC routing module.
+ * The trie is released.
+ */
+void OSCROUTE_deinit(void);
+
+/**
+ * @brief Find the destination of a variable.
+ * @param pAddress Variable name (OSC address)
+ * @return Destination with the longest prefix of the variable or NULL if
+ *         the variable is not routed
+ */
+const T_OSCROUTE_Destination* OSCROUTE_find(const char *pAddress);
+
+/**
+ * @brief Get a destination.
+ * @param index Index of the destination, 0 is set with osc_host, osc_port
+ *              and osc_prefix
+ * @return Destination or NULL if index is out of range
+ */
+const T_OSCROUTE_Destination* OSCROUTE_get(int index);
+
+/** @} OSCROUTE */
+
+#endif // _OSC_ROUTE_H_
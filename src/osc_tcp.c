@@ -0,0 +1,452 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "osc_tcp.h"
+
+#if OSC_TCP_EN
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "osc_route.h"
+#ifdef _WIN32
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#else
+  #include <sys/socket.h>
+  #include <netinet/in.h>
+  #include <arpa/inet.h>
+  #include <netdb.h>
+#endif
+
+/****************************************************************************/
+
+/** SLIP frame delimiter */
+#define SLIP_END                    0xC0
+
+/** SLIP escape character */
+#define SLIP_ESC                    0xDB
+
+/** Escaped frame delimiter */
+#define SLIP_ESC_END                0xDC
+
+/** Escaped escape character */
+#define SLIP_ESC_ESC                0xDD
+
+/** Size of the buffer a packet is encoded in piece by piece */
+#define SLIP_CHUNK_SIZE             512
+
+/** @brief Packet waiting for the connection */
+typedef struct t_OSCTCP_Pending
+{
+    char *pPacket;              /**< OSC message or bundle */
+    int len;                    /**< Length of the packet */
+    unsigned int hash;          /**< Hash of the address of a coalesced message, 0 for other packets */
+} T_OSCTCP_Pending, *PT_OSCTCP_Pending;
+
+/** @brief OSC host reached over TCP */
+typedef struct t_OSCTCP_Destination
+{
+    char host[CONFIG_BUFFER_SIZE];          /**< Host name or IP, empty if the entry is free */
+    int port;                               /**< Port number */
+    char address[64];                       /**< Resolved address ("IP:port"), empty if the host is unknown */
+    struct mg_tcp_connection *conn;         /**< Connection, NULL if closed */
+    int connected;                          /**< 1 when the connection is established */
+    time_t lastAttempt;                     /**< Time of the last connection attempt */
+    T_OSCTCP_Pending queue[OSC_TCP_QUEUE_SIZE]; /**< Packets waiting for the connection, oldest first */
+    int numQueued;                          /**< Number of queued packets */
+} T_OSCTCP_Destination, *PT_OSCTCP_Destination;
+
+/** Web-server handling the connections, NULL before OSCTCP_init() */
+static struct mg_server *server = NULL;
+
+/** OSC hosts reached over TCP */
+static T_OSCTCP_Destination destinations[OSC_TCP_MAX_DESTINATIONS];
+
+/** Statistics */
+static T_OSCTCP_Stats stats;
+
+/****************************************************************************/
+
+static void handleEvent(void *pParam, struct mg_tcp_connection *conn, int ev);
+
+/**
+ * @brief Hash an OSC address (FNV-1a).
+ * @param pAddress OSC address
+ * @return Hash, never 0
+ */
+static unsigned int hashAddress(const char *pAddress)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*pAddress)
+        hash = (hash ^ (unsigned char)*pAddress++) * 16777619u;
+    return hash ? hash : 1;
+}
+
+/**
+ * @brief Write a packet as SLIP frame to a connection.
+ * @param conn Connection
+ * @param pPacket OSC message or bundle
+ * @param len Length of the packet
+ */
+static void writeFrame(struct mg_tcp_connection *conn, const char *pPacket, int len)
+{
+    unsigned char chunk[SLIP_CHUNK_SIZE];
+    int n = 0;
+    int i;
+
+    chunk[n++] = SLIP_END;
+    for (i = 0; i < len; i++)
+    {
+        unsigned char c = (unsigned char)pPacket[i];
+
+        // room for an escaped character and the closing delimiter
+        if (n > SLIP_CHUNK_SIZE - 3)
+        {
+            mg_tcp_write(conn, chunk, n);
+            n = 0;
+        }
+        if (c == SLIP_END)
+        {
+            chunk[n++] = SLIP_ESC;
+            chunk[n++] = SLIP_ESC_END;
+        }
+        else if (c == SLIP_ESC)
+        {
+            chunk[n++] = SLIP_ESC;
+            chunk[n++] = SLIP_ESC_ESC;
+        }
+        else
+            chunk[n++] = c;
+    }
+    chunk[n++] = SLIP_END;
+    mg_tcp_write(conn, chunk, n);
+    stats.sent++;
+}
+
+/**
+ * @brief Check whether a destination takes packets at once.
+ * @param pDestination Destination
+ * @return 1 if the connection is established and not congested
+ */
+static int isWritable(PT_OSCTCP_Destination pDestination)
+{
+    return pDestination->connected && mg_tcp_pending(pDestination->conn) < OSC_TCP_HIGH_WATER;
+}
+
+/**
+ * @brief Write the queued packets of a destination until it is congested.
+ * @param pDestination Destination
+ */
+static void drainQueue(PT_OSCTCP_Destination pDestination)
+{
+    int i = 0;
+
+    while (i < pDestination->numQueued && isWritable(pDestination))
+    {
+        writeFrame(pDestination->conn, pDestination->queue[i].pPacket, pDestination->queue[i].len);
+        SYS_free(pDestination->queue[i].pPacket);
+        i++;
+    }
+    if (i > 0)
+    {
+        pDestination->numQueued -= i;
+        memmove(&pDestination->queue[0], &pDestination->queue[i], pDestination->numQueued * sizeof(T_OSCTCP_Pending));
+    }
+}
+
+/**
+ * @brief Queue a packet for a destination.
+ * A coalesced message replaces the queued coalesced message with the same
+ * address. The new value goes to the end of the queue, so it still follows
+ * the packets queued before it.
+ * @param pDestination Destination
+ * @param pPacket OSC message or bundle
+ * @param len Length of the packet
+ * @param coalesce 1 if the packet is a message which may replace a queued one
+ * @return 0 on success, -1 if the packet is dropped
+ */
+static int queuePacket(PT_OSCTCP_Destination pDestination, const char *pPacket, int len, int coalesce)
+{
+    PT_OSCTCP_Pending pPending;
+    unsigned int hash = 0;
+    char *pCopy;
+    int i;
+
+    if (coalesce && *pPacket != '#')
+    {
+        hash = hashAddress(pPacket);
+        for (i = 0; i < pDestination->numQueued; i++)
+        {
+            if (pDestination->queue[i].hash == hash && strcmp(pDestination->queue[i].pPacket, pPacket) == 0)
+            {
+                SYS_free(pDestination->queue[i].pPacket);
+                pDestination->numQueued--;
+                memmove(&pDestination->queue[i], &pDestination->queue[i + 1], (pDestination->numQueued - i) * sizeof(T_OSCTCP_Pending));
+                stats.coalesced++;
+                break;
+            }
+        }
+    }
+
+    if (pDestination->numQueued >= OSC_TCP_QUEUE_SIZE)
+    {
+        stats.dropped++;
+        return -1;
+    }
+
+    if ((pCopy = (char*)SYS_malloc(len)) == NULL)
+    {
+        stats.dropped++;
+        return -1;
+    }
+    memcpy(pCopy, pPacket, len);
+
+    pPending = &pDestination->queue[pDestination->numQueued++];
+    pPending->pPacket = pCopy;
+    pPending->len = len;
+    pPending->hash = hash;
+    return 0;
+}
+
+/**
+ * @brief Queue a packet for a destination. A bundle of coalesced messages
+ * is split into its elements so that its messages can be coalesced, other
+ * packets are queued whole.
+ * @param pDestination Destination
+ * @param pPacket OSC message or bundle
+ * @param len Length of the packet
+ * @param coalesce 1 if the packet carries the coalesced messages of OSC_flush()
+ * @return 0 on success, -1 if a packet is dropped
+ */
+static int queueElements(PT_OSCTCP_Destination pDestination, const char *pPacket, int len, int coalesce)
+{
+    static const char immediate[16] = "#bundle\0\0\0\0\0\0\0\0\1";
+    const char *pEnd = pPacket + len;
+    int ret = 0;
+
+    if (!coalesce || len < 16 || memcmp(pPacket, immediate, 16) != 0)
+        return queuePacket(pDestination, pPacket, len, coalesce);
+
+    pPacket += 16;
+    while (pEnd - pPacket >= 4)
+    {
+        const unsigned char *p = (const unsigned char*)pPacket;
+        unsigned int size = ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+        pPacket += 4;
+        if (size == 0 || size > (unsigned int)(pEnd - pPacket))
+            break;
+        if (queuePacket(pDestination, pPacket, (int)size, 1))
+            ret = -1;
+        pPacket += size;
+    }
+    return ret;
+}
+
+/**
+ * @brief Resolve the host name of a destination.
+ * The name is resolved only once, so the event loop never waits for DNS
+ * when a connection is opened again.
+ * @param pDestination Destination
+ */
+static void resolveDestination(PT_OSCTCP_Destination pDestination)
+{
+    struct addrinfo hints;
+    struct addrinfo *pList;
+    char ip[INET_ADDRSTRLEN];
+
+    pDestination->address[0] = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(pDestination->host, NULL, &hints, &pList) != 0)
+    {
+        printf("Cannot resolve OSC host \"%s\"\n", pDestination->host);
+        return;
+    }
+    if (inet_ntop(AF_INET, &((const struct sockaddr_in*)pList->ai_addr)->sin_addr, ip, sizeof(ip)))
+        sprintf(pDestination->address, "%s:%d", ip, pDestination->port);
+    freeaddrinfo(pList);
+}
+
+/**
+ * @brief Open the connection of a destination.
+ * @param pDestination Destination
+ */
+static void connectDestination(PT_OSCTCP_Destination pDestination)
+{
+    pDestination->lastAttempt = time(NULL);
+    if (pDestination->address[0])
+        pDestination->conn = mg_connect_tcp(server, pDestination->address, handleEvent, pDestination);
+}
+
+/**
+ * @brief Handle the events of the connection of a destination.
+ * @param pParam Destination
+ * @param conn Connection
+ * @param ev MG_TCP_CONNECT, MG_TCP_POLL or MG_TCP_CLOSE
+ */
+static void handleEvent(void *pParam, struct mg_tcp_connection *conn, int ev)
+{
+    PT_OSCTCP_Destination pDestination = (PT_OSCTCP_Destination)pParam;
+
+    if (pDestination->conn != conn)
+        return;
+
+    switch (ev)
+    {
+    case MG_TCP_CONNECT:
+        pDestination->connected = 1;
+        stats.connects++;
+        drainQueue(pDestination);
+        break;
+    case MG_TCP_POLL:
+        // write the queued packets as far as the host takes them
+        drainQueue(pDestination);
+        break;
+    case MG_TCP_CLOSE:
+        // data not written yet is lost, OSCTCP_refresh() connects again
+        pDestination->conn = NULL;
+        pDestination->connected = 0;
+        break;
+    }
+}
+
+/**
+ * @brief Get the destination of a host, a new destination is resolved and
+ * connected. The destinations of the routing table are created by
+ * OSCTCP_init(), so only the names of other hosts are resolved later.
+ * @param host Host name or IP
+ * @param port Port number of the host
+ * @return Destination, NULL if all entries are used
+ */
+static PT_OSCTCP_Destination getDestination(const char *host, int port)
+{
+    PT_OSCTCP_Destination pFree = NULL;
+    int i;
+
+    for (i = 0; i < OSC_TCP_MAX_DESTINATIONS; i++)
+    {
+        if (destinations[i].host[0] == 0)
+        {
+            if (pFree == NULL)
+                pFree = &destinations[i];
+        }
+        else if (destinations[i].port == port && strcmp(destinations[i].host, host) == 0)
+            return &destinations[i];
+    }
+
+    if (pFree)
+    {
+        strncpy(pFree->host, host, CONFIG_BUFFER_SIZE - 1);
+        pFree->port = port;
+        resolveDestination(pFree);
+        if (server)
+            connectDestination(pFree);
+    }
+    return pFree;
+}
+
+/****************************************************************************/
+
+/**
+ */
+void OSCTCP_init(struct mg_server *pServer)
+{
+    const T_OSCROUTE_Destination *pRoute;
+    int i;
+
+    // resolve the OSC hosts reached over TCP now rather than in the event loop
+    for (i = 0; (pRoute = OSCROUTE_get(i)) != NULL; i++)
+    {
+        if (strncmp(pRoute->host, OSCTCP_SCHEME, sizeof(OSCTCP_SCHEME) - 1) == 0)
+            getDestination(pRoute->host + sizeof(OSCTCP_SCHEME) - 1, pRoute->port);
+    }
+
+    server = pServer;
+    for (i = 0; i < OSC_TCP_MAX_DESTINATIONS; i++)
+    {
+        if (destinations[i].host[0] && destinations[i].conn == NULL)
+            connectDestination(&destinations[i]);
+    }
+}
+
+/**
+ */
+void OSCTCP_deinit(void)
+{
+    int i, j;
+
+    for (i = 0; i < OSC_TCP_MAX_DESTINATIONS; i++)
+    {
+        for (j = 0; j < destinations[i].numQueued; j++)
+            SYS_free(destinations[i].queue[j].pPacket);
+    }
+    memset(destinations, 0, sizeof(destinations));
+    server = NULL;
+}
+
+/**
+ */
+void OSCTCP_refresh(void)
+{
+    time_t now;
+    int i;
+
+    if (server == NULL)
+        return;
+
+    now = time(NULL);
+    for (i = 0; i < OSC_TCP_MAX_DESTINATIONS; i++)
+    {
+        if (destinations[i].host[0] && destinations[i].conn == NULL && now - destinations[i].lastAttempt >= OSC_TCP_RECONNECT_INTERVAL)
+            connectDestination(&destinations[i]);
+    }
+}
+
+/**
+ */
+int OSCTCP_send(const char *host, int port, const char *pPacket, int len, int coalesce)
+{
+    PT_OSCTCP_Destination pDestination = getDestination(host, port);
+
+    if (pDestination == NULL)
+    {
+        stats.dropped++;
+        return -1;
+    }
+
+    // keep the order, queued packets go first
+    if (pDestination->numQueued == 0 && isWritable(pDestination))
+    {
+        writeFrame(pDestination->conn, pPacket, len);
+        return 0;
+    }
+    return queueElements(pDestination, pPacket, len, coalesce);
+}
+
+/**
+ */
+void OSCTCP_getStats(PT_OSCTCP_Stats pStats)
+{
+    *pStats = stats;
+}
+
+#endif // OSC_TCP_EN
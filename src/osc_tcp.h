@@ -0,0 +1,110 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file osc_tcp.h
+ *  @brief OSC over TCP with SLIP framing.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _OSC_TCP_H_
+#define _OSC_TCP_H_
+
+#include "release.h"
+#include "mongoose.h"
+
+/**
+ * @defgroup OSCTCP OSC over TCP
+ * @brief Stream transport of OSC 1.1 (SLIP framing) to the OSC hosts.
+ *
+ * An OSC host whose name starts with OSCTCP_SCHEME is reached over TCP
+ * instead of UDP, e.g. osc_host = "tcp://synth.local". Every packet is sent
+ * as a double-ended SLIP frame (RFC 1055).
+ *
+ * The connections are non-blocking and handled by the event loop of the
+ * web-server. A lost connection is opened again every
+ * OSC_TCP_RECONNECT_INTERVAL seconds.
+ *
+ * While a host is disconnected or reads slower than the packets arrive
+ * (more than OSC_TCP_HIGH_WATER bytes not sent yet), the packets are kept
+ * in a queue of OSC_TCP_QUEUE_SIZE entries. The messages coalesced by the
+ * OSC module (see OSC_flush()) are split out of their bundles there and a
+ * message replaces the queued message of the same address, so the host
+ * receives the latest values when it catches up. The new value moves to the
+ * end of the queue to keep the order of the values. Other packets, e.g. the
+ * bundles of transactions, are queued whole. A packet is dropped if the
+ * queue is full.
+ * @{
+ */
+
+/** Prefix of the names of the OSC hosts reached over TCP */
+#define OSCTCP_SCHEME               "tcp://"
+
+/** @brief Statistics of the OSC hosts reached over TCP */
+typedef struct t_OSCTCP_Stats
+{
+    unsigned long sent;         /**< number of packets written to the connections */
+    unsigned long coalesced;    /**< number of queued messages replaced by a newer value */
+    unsigned long dropped;      /**< number of packets dropped because the queue was full */
+    unsigned long connects;     /**< number of established connections */
+} T_OSCTCP_Stats, *PT_OSCTCP_Stats;
+
+/**
+ * @brief Initialize the OSC over TCP module.
+ * The names of the OSC hosts of the routing table (see OSCROUTE) are
+ * resolved once here. The packets sent before are queued, the connections
+ * are opened now.
+ * @param server Web-server handling the connections
+ */
+void OSCTCP_init(struct mg_server *server);
+
+/**
+ * @brief De-initialize the OSC over TCP module.
+ * The queued packets are released and no connection is opened anymore.
+ * Call it before the web-server is destroyed, the connections closed by the
+ * web-server are ignored.
+ */
+void OSCTCP_deinit(void);
+
+/**
+ * @brief Open the lost connections again if they are due.
+ * Call this function after every iteration of the main loop.
+ */
+void OSCTCP_refresh(void);
+
+/**
+ * @brief Send a packet to an OSC host over TCP.
+ * @param host Host name or IP without OSCTCP_SCHEME
+ * @param port Port number of the host
+ * @param pPacket OSC message or bundle
+ * @param len Length of the packet
+ * @param coalesce 1 if the packet carries the coalesced messages of
+ *        OSC_flush(), which may replace queued messages of the same address
+ * @return 0 if the packet is written or queued, -1 if it is dropped
+ */
+int OSCTCP_send(const char *host, int port, const char *pPacket, int len, int coalesce);
+
+/**
+ * @brief Get the statistics of the OSC hosts reached over TCP.
+ * @param pStats Structure receiving the statistics
+ */
+void OSCTCP_getStats(PT_OSCTCP_Stats pStats);
+
+/** @} OSCTCP */
+
+#endif // _OSC_TCP_H_
@@ -0,0 +1,300 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "push.h"
+
+#if PUSH_EN
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "route.h"
+#include "strbuf.h"
+
+/****************************************************************************/
+
+/** Maximal number of change batches queued per subscriber */
+#define PUSH_QUEUE_SIZE             16
+
+/** Interval in seconds after which a keep-alive is sent to idle subscribers */
+#define PUSH_KEEPALIVE_INTERVAL     30
+
+/** Pending send bytes of a subscriber above which its queue is not drained */
+#define PUSH_HIGH_WATER             65536
+
+/** @brief Reference-counted buffer containing one serialized change batch */
+typedef struct t_PushBuffer
+{
+    int    refCount;                /**< number of references to this buffer */
+    size_t len;                     /**< length of the data */
+    char   data[1];                 /**< serialized data (allocated with the structure) */
+} T_PushBuffer, *PT_PushBuffer;
+
+/** @brief Structure for a subscriber */
+typedef struct t_PushSubscriber
+{
+    struct mg_connection *conn;             /**< subscribed connection */
+    PT_PushBuffer queue[PUSH_QUEUE_SIZE];   /**< send queue */
+    int head;                               /**< index of the first queued buffer */
+    int count;                              /**< number of queued buffers */
+    int overflow;                           /**< set if the send queue was full */
+    struct t_PushSubscriber *pNext;         /**< pointer to the next list entry */
+} T_PushSubscriber, *PT_PushSubscriber;
+
+/****************************************************************************/
+
+/** List of subscribers */
+static PT_PushSubscriber pSubscribers = NULL;
+
+/** Number of subscribers */
+static int numSubscribers = 0;
+
+/** Current change batch (comma separated JSON objects) */
+static T_StrBuf batch;
+
+/** Time the last buffer was queued */
+static time_t lastQueued = 0;
+
+/****************************************************************************/
+
+/**
+ * @brief Allocate a new buffer with a reference count of 1.
+ * @param pPrefix String put before the data
+ * @param pData Data
+ * @param len Length of the data
+ * @param pSuffix String put after the data
+ * @return Pointer to the new buffer or NULL if out of memory
+ */
+static PT_PushBuffer createBuffer(const char *pPrefix, const char *pData, size_t len, const char *pSuffix)
+{
+    size_t prefixLen = strlen(pPrefix);
+    size_t suffixLen = strlen(pSuffix);
+    PT_PushBuffer pBuffer;
+
+    pBuffer = SYS_malloc(sizeof(T_PushBuffer) + prefixLen + len + suffixLen);
+    if (pBuffer)
+    {
+        pBuffer->refCount = 1;
+        pBuffer->len = prefixLen + len + suffixLen;
+        memcpy(pBuffer->data, pPrefix, prefixLen);
+        memcpy(pBuffer->data + prefixLen, pData, len);
+        memcpy(pBuffer->data + prefixLen + len, pSuffix, suffixLen);
+    }
+    return pBuffer;
+}
+
+/**
+ * @brief Release a reference to a buffer. The buffer is freed with the last reference.
+ * @param pBuffer Buffer
+ */
+static void releaseBuffer(PT_PushBuffer pBuffer)
+{
+    if (--pBuffer->refCount == 0)
+        SYS_free(pBuffer);
+}
+
+/**
+ * @brief Attach a buffer to the send queue of every subscriber.
+ * @param pBuffer Buffer
+ */
+static void queueBuffer(PT_PushBuffer pBuffer)
+{
+    PT_PushSubscriber pSub;
+
+    for (pSub = pSubscribers; pSub; pSub = pSub->pNext)
+    {
+        if (pSub->count == PUSH_QUEUE_SIZE)
+        {
+            // subscriber is too slow, it will be disconnected
+            pSub->overflow = 1;
+            continue;
+        }
+        pSub->queue[(pSub->head + pSub->count) % PUSH_QUEUE_SIZE] = pBuffer;
+        pSub->count++;
+        pBuffer->refCount++;
+    }
+}
+
+/**
+ * @brief Remove a subscriber from the list and free it.
+ * @param pSub Subscriber
+ */
+static void removeSubscriber(PT_PushSubscriber pSub)
+{
+    PT_PushSubscriber *ppSub = &pSubscribers;
+
+    // unlink subscriber
+    while (*ppSub)
+    {
+        if (*ppSub == pSub)
+        {
+            *ppSub = pSub->pNext;
+            numSubscribers--;
+            break;
+        }
+        ppSub = &(*ppSub)->pNext;
+    }
+
+    // release queued buffers
+    while (pSub->count)
+    {
+        releaseBuffer(pSub->queue[pSub->head]);
+        pSub->head = (pSub->head + 1) % PUSH_QUEUE_SIZE;
+        pSub->count--;
+    }
+
+    pSub->conn->connection_param = NULL;
+    SYS_free(pSub);
+}
+
+/****************************************************************************/
+
+/** Route of the subscription requests */
+static const T_Route route = { ROUTE_CGI_PATH "push.cgi", ROUTE_GET, ROUTE_LIMIT_READ, PUSH_processRequest, NULL, PUSH_poll, PUSH_close };
+
+/**
+ */
+void PUSH_init(void)
+{
+    STRBUF_init(&batch);
+    lastQueued = time(NULL);
+    ROUTE_register(&route);
+}
+
+/**
+ */
+void PUSH_deinit(void)
+{
+    while (pSubscribers)
+        removeSubscriber(pSubscribers);
+    STRBUF_free(&batch);
+}
+
+/**
+ */
+void PUSH_notify(const char *pVariable, const char *pValue)
+{
+    // nobody is interested
+    if (numSubscribers == 0)
+        return;
+
+    if (batch.len)
+        STRBUF_append(&batch, ",", 1);
+    STRBUF_append(&batch, "{\"var\":\"", 8);
+    STRBUF_appendJsonString(&batch, pVariable, strlen(pVariable));
+    STRBUF_append(&batch, "\",\"val\":\"", 9);
+    STRBUF_appendJsonString(&batch, pValue, strlen(pValue));
+    STRBUF_append(&batch, "\"}", 2);
+}
+
+/**
+ */
+void PUSH_flush(void)
+{
+    PT_PushBuffer pBuffer = NULL;
+    time_t now = time(NULL);
+
+    if (batch.len)
+    {
+        // serialize the change batch only once for all subscribers
+        if (numSubscribers)
+            pBuffer = createBuffer("data: {\"version\":\"1\",\"write\":[", batch.pData, batch.len, "]}\n\n");
+        STRBUF_reset(&batch);
+    }
+    else if (numSubscribers && now - lastQueued >= PUSH_KEEPALIVE_INTERVAL)
+    {
+        // comment line to keep idle connections open
+        pBuffer = createBuffer(":", "", 0, "\n\n");
+    }
+
+    if (pBuffer)
+    {
+        queueBuffer(pBuffer);
+        releaseBuffer(pBuffer);
+        lastQueued = now;
+    }
+}
+
+/**
+ */
+int PUSH_processRequest(struct mg_connection *conn)
+{
+    PT_PushSubscriber pSub = SYS_malloc(sizeof(T_PushSubscriber));
+    if (!pSub)
+    {
+        mg_send_status(conn, 503);
+        mg_send_data(conn, "", 0);
+        return MG_TRUE;
+    }
+
+    memset(pSub, 0, sizeof(T_PushSubscriber));
+    pSub->conn = conn;
+    pSub->pNext = pSubscribers;
+    pSubscribers = pSub;
+    numSubscribers++;
+    conn->connection_param = pSub;
+
+    // send HTTP header now, the stream stays open until the connection closes
+    // (no chunked encoding, so the shared buffers are sent as they are)
+    mg_send_status(conn, 200);
+    mg_send_header(conn, "Content-Type", "text/event-stream");
+    mg_send_header(conn, "Cache-Control", "no-cache");
+    mg_send_header(conn, "Connection", "close");
+    mg_write(conn, "\r\n:\n\n", 5);
+
+    return MG_MORE;
+}
+
+/**
+ */
+int PUSH_poll(struct mg_connection *conn)
+{
+    PT_PushSubscriber pSub = (PT_PushSubscriber)conn->connection_param;
+    if (!pSub)
+        return MG_FALSE;
+
+    // close the stream of a subscriber missing batches, the client reconnects
+    if (pSub->overflow)
+    {
+        removeSubscriber(pSub);
+        return MG_TRUE;
+    }
+
+    // send queued buffers as long as the client keeps up, a stalled client
+    // keeps them queued until its queue overflows
+    while (pSub->count && mg_send_pending(conn) < PUSH_HIGH_WATER)
+    {
+        PT_PushBuffer pBuffer = pSub->queue[pSub->head];
+        mg_write_direct(conn, pBuffer->data, (int)pBuffer->len);
+        releaseBuffer(pBuffer);
+        pSub->head = (pSub->head + 1) % PUSH_QUEUE_SIZE;
+        pSub->count--;
+    }
+
+    return MG_FALSE;
+}
+
+/**
+ */
+void PUSH_close(struct mg_connection *conn)
+{
+    PT_PushSubscriber pSub = (PT_PushSubscriber)conn->connection_param;
+    if (pSub)
+        removeSubscriber(pSub);
+}
+
+#endif // PUSH_EN
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file push.h
+ *  @brief Functions to push data-pool changes to web clients.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _PUSH_H_
+#define _PUSH_H_
+
+#include "release.h"
+#include "mongoose.h"
+
+/**
+ * @defgroup PUSH Push
+ * @brief Pushes data-pool changes to subscribed web clients.
+ *
+ * A client subscribes by requesting push.cgi. The connection is kept open
+ * and every change of the data-pool is sent as a server-sent event
+ * (text/event-stream) containing the same JSON data as a write response:
+ *
+ *  <PRE>
+ *  data: {"version":"1","write":[{"var":"/osc/sb_fuzz/drive","val":"30"}]}
+ *  </PRE>
+ *
+ * Changes are collected with PUSH_notify() and serialized only once per
+ * call of PUSH_flush() into a reference-counted buffer. This buffer is then
+ * attached to the send queue of every subscriber, so the cost of formatting
+ * does not depend on the number of subscribers. The stream is not chunked,
+ * so the buffer is written to the socket as it is and only copied into the
+ * send buffer of a subscriber if the socket does not take it at once.
+ * A subscriber with more than PUSH_HIGH_WATER pending bytes is not sent
+ * anything more; once its send queue overflows the stream is closed and the
+ * client reconnects.
+ *
+ * <b>Example</b>
+ * <pre>
+ * http://server_url/cgi-bin/push.cgi
+ * </pre>
+ * @{
+ */
+
+/**
+ * @brief Initialize the push module.
+ * The route of push.cgi is registered (see ROUTE_register()).
+ */
+void PUSH_init(void);
+
+/**
+ * @brief De-initialize the push module.
+ * This will release all pending buffers.
+ */
+void PUSH_deinit(void);
+
+/**
+ * @brief Add a changed variable to the current change batch.
+ * @param pVariable Variable name
+ * @param pValue New value
+ */
+void PUSH_notify(const char *pVariable, const char *pValue);
+
+/**
+ * @brief Serialize the current change batch and queue it to all subscribers.
+ * Call this function once per main loop iteration.
+ */
+void PUSH_flush(void);
+
+/**
+ * @brief CGI request to subscribe to data-pool changes.
+ * @param conn HTTP request containing incoming data
+ * @return MG_MORE to keep the connection open, MG_TRUE on error
+ */
+int PUSH_processRequest(struct mg_connection *conn);
+
+/**
+ * @brief Send the queued change batches of a subscriber.
+ * @param conn Subscribed HTTP connection
+ * @return MG_FALSE to keep the connection open, MG_TRUE to close it
+ */
+int PUSH_poll(struct mg_connection *conn);
+
+/**
+ * @brief Remove a subscriber when its connection is closed.
+ * @param conn Subscribed HTTP connection
+ */
+void PUSH_close(struct mg_connection *conn);
+
+/** @} PUSH */
+
+#endif // _PUSH_H_
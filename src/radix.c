@@ -0,0 +1,185 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "release.h"
+#include "radix.h"
+
+/****************************************************************************/
+
+/**
+ * @brief Allocate a node.
+ * @param pLabel Label
+ * @param len Length of the label
+ * @return New node or NULL if out of memory
+ */
+static PT_RadixNode newNode(const char *pLabel, size_t len)
+{
+    PT_RadixNode pNode = SYS_malloc(sizeof(T_RadixNode));
+    if (!pNode)
+        return NULL;
+    pNode->pLabel = SYS_malloc(len + 1);
+    if (!pNode->pLabel)
+    {
+        SYS_free(pNode);
+        return NULL;
+    }
+    memcpy(pNode->pLabel, pLabel, len);
+    pNode->pLabel[len] = '\0';
+    pNode->len = len;
+    pNode->pValue = NULL;
+    pNode->pChild = NULL;
+    pNode->pNext = NULL;
+    return pNode;
+}
+
+/**
+ * @brief Free the children of a node.
+ * @param pNode Node
+ */
+static void freeChildren(PT_RadixNode pNode)
+{
+    PT_RadixNode pChild = pNode->pChild;
+    while (pChild)
+    {
+        PT_RadixNode pNext = pChild->pNext;
+        freeChildren(pChild);
+        SYS_free(pChild->pLabel);
+        SYS_free(pChild);
+        pChild = pNext;
+    }
+    pNode->pChild = NULL;
+}
+
+/**
+ * @brief Find the child of a node starting with a character.
+ * @param pNode Node
+ * @param c First character of the label
+ * @return Child or NULL if not found
+ */
+static PT_RadixNode findChild(PT_RadixNode pNode, char c)
+{
+    PT_RadixNode pChild = pNode->pChild;
+    while (pChild && pChild->pLabel[0] != c)
+        pChild = pChild->pNext;
+    return pChild;
+}
+
+/****************************************************************************/
+
+/**
+ */
+void RADIX_free(PT_RadixNode pRoot)
+{
+    freeChildren(pRoot);
+    pRoot->pValue = NULL;
+}
+
+/**
+ */
+PT_RadixNode RADIX_insert(PT_RadixNode pRoot, const char *pKey)
+{
+    PT_RadixNode pNode = pRoot;
+
+    while (*pKey)
+    {
+        PT_RadixNode pChild = findChild(pNode, *pKey);
+        size_t len = 0;
+
+        if (!pChild)
+        {
+            // new leaf with the rest of the key
+            pChild = newNode(pKey, strlen(pKey));
+            if (!pChild)
+                return NULL;
+            pChild->pNext = pNode->pChild;
+            pNode->pChild = pChild;
+            return pChild;
+        }
+
+        while (len < pChild->len && pChild->pLabel[len] == pKey[len])
+            len++;
+
+        if (len < pChild->len)
+        {
+            // split the label at the first difference
+            PT_RadixNode pSplit = newNode(pChild->pLabel, len);
+            if (!pSplit)
+                return NULL;
+            memmove(pChild->pLabel, pChild->pLabel + len, pChild->len - len + 1);
+            pChild->len -= len;
+
+            // replace the child by the split node
+            if (pNode->pChild == pChild)
+            {
+                pNode->pChild = pSplit;
+            }
+            else
+            {
+                PT_RadixNode pPrev = pNode->pChild;
+                while (pPrev->pNext != pChild)
+                    pPrev = pPrev->pNext;
+                pPrev->pNext = pSplit;
+            }
+            pSplit->pNext = pChild->pNext;
+            pChild->pNext = NULL;
+            pSplit->pChild = pChild;
+            pChild = pSplit;
+        }
+
+        pNode = pChild;
+        pKey += len;
+    }
+    return pNode;
+}
+
+/**
+ */
+void* RADIX_find(PT_RadixNode pRoot, const char *pKey)
+{
+    PT_RadixNode pNode = pRoot;
+
+    while (*pKey)
+    {
+        pNode = findChild(pNode, *pKey);
+        if (!pNode || strncmp(pNode->pLabel, pKey, pNode->len) != 0)
+            return NULL;
+        pKey += pNode->len;
+    }
+    return pNode->pValue;
+}
+
+/**
+ */
+void* RADIX_findPrefix(PT_RadixNode pRoot, const char *pString)
+{
+    PT_RadixNode pNode = pRoot;
+    void *pValue = pRoot->pValue;
+
+    // the deepest node with a value has the longest key
+    while (*pString)
+    {
+        pNode = findChild(pNode, *pString);
+        if (!pNode || strncmp(pNode->pLabel, pString, pNode->len) != 0)
+            break;
+        pString += pNode->len;
+        if (pNode->pValue)
+            pValue = pNode->pValue;
+    }
+    return pValue;
+}
@@ -0,0 +1,95 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file radix.h
+ *  @brief Radix trie of strings.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _RADIX_H_
+#define _RADIX_H_
+
+#include <stddef.h>
+
+/**
+ * @addtogroup UTILITIES
+ * @{
+ */
+
+/**
+ * @defgroup RADIX Radix Trie
+ * @brief Radix trie mapping strings to values.
+ *
+ * Every node holds the part of the key (label) leading to it from its
+ * parent, a node is split when a new key differs inside its label. Finding
+ * a key costs O(length of the key) whatever the number of keys.
+ *
+ * The root node is provided by the caller, usually as a static variable
+ * initialized to zero. Its label is empty and its value belongs to the
+ * empty key.
+ * @{
+ */
+
+/** @brief Node of a radix trie */
+typedef struct t_RadixNode
+{
+    char *pLabel;                   /**< part of the key leading to this node */
+    size_t len;                     /**< length of the label */
+    void *pValue;                   /**< value of the key ending at this node, can be NULL */
+    struct t_RadixNode *pChild;     /**< first child */
+    struct t_RadixNode *pNext;      /**< next sibling */
+} T_RadixNode, *PT_RadixNode;
+
+/**
+ * @brief Remove all keys of a radix trie.
+ * The nodes below the root are freed, the values are not.
+ * @param pRoot Root node
+ */
+void RADIX_free(PT_RadixNode pRoot);
+
+/**
+ * @brief Find or insert the node of a key.
+ * @param pRoot Root node
+ * @param pKey Key
+ * @return Node of the key, its value is NULL if the key is new, or NULL
+ *         if out of memory
+ */
+PT_RadixNode RADIX_insert(PT_RadixNode pRoot, const char *pKey);
+
+/**
+ * @brief Find the value of a key.
+ * @param pRoot Root node
+ * @param pKey Key
+ * @return Value or NULL if the key is not found
+ */
+void* RADIX_find(PT_RadixNode pRoot, const char *pKey);
+
+/**
+ * @brief Find the value of the longest key which is a prefix of a string.
+ * @param pRoot Root node
+ * @param pString String
+ * @return Value or NULL if no key is a prefix of the string
+ */
+void* RADIX_findPrefix(PT_RadixNode pRoot, const char *pString);
+
+/** @} RADIX */
+
+/** @} UTILITIES */
+
+#endif // _RADIX_H_
@@ -0,0 +1,263 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "ratelimit.h"
+
+#if RATE_EN
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+/****************************************************************************/
+
+/** Maximal length of a client address (IPv6) */
+#define RATE_ADDRESS_SIZE           48
+
+/** @brief Buckets of a client */
+typedef struct t_RateClient
+{
+    char address[RATE_ADDRESS_SIZE];    /**< client address */
+    double tokens[RATE_TYPES];          /**< tokens in the buckets */
+    unsigned long long lastUs;          /**< time of the last refill in microseconds */
+    struct t_RateClient *pNext;         /**< next client in the same slot */
+} T_RateClient, *PT_RateClient;
+
+/****************************************************************************/
+
+/** Hash table of the clients */
+static PT_RateClient table[RATE_TABLE_SIZE];
+
+/** Number of clients in the hash table */
+static int numClients = 0;
+
+/****************************************************************************/
+
+/**
+ * @brief Compute the hash of a client address (FNV-1a).
+ * @param pAddress Client address
+ * @return Hash value
+ */
+static unsigned int hashAddress(const char *pAddress)
+{
+    unsigned int hash = 2166136261u;
+    while (*pAddress)
+    {
+        hash ^= (unsigned char)*pAddress++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Get the configured limit of a bucket.
+ * @param type RATE_READ or RATE_WRITE
+ * @param pBurst Receives the size of the bucket, at least 1
+ * @return Tokens added per second, 0 if there is no limit
+ */
+static double getLimit(int type, double *pBurst)
+{
+    int rate = type == RATE_READ ? app.limit_read_rate : app.limit_write_rate;
+    int burst = type == RATE_READ ? app.limit_read_burst : app.limit_write_burst;
+    *pBurst = burst < 1 ? 1.0 : (double)burst;
+    return rate < 0 ? 0.0 : (double)rate;
+}
+
+/**
+ * @brief Add the tokens earned since the last refill to the buckets of a client.
+ * @param pClient Client
+ * @param now Current time in microseconds
+ */
+static void refill(PT_RateClient pClient, unsigned long long now)
+{
+    double seconds = (double)(now - pClient->lastUs) / 1000000.0;
+    double burst;
+    int type;
+
+    for (type = 0; type < RATE_TYPES; type++)
+    {
+        pClient->tokens[type] += seconds * getLimit(type, &burst);
+        if (pClient->tokens[type] > burst)
+            pClient->tokens[type] = burst;
+    }
+    pClient->lastUs = now;
+}
+
+/**
+ * @brief Check if a client can be removed.
+ * A client is removed when it has been idle for RATE_IDLE_TIMEOUT seconds and
+ * its buckets are full, so removing it does not change its limits.
+ * @param pClient Client
+ * @param now Current time in microseconds
+ * @return 1 if the client can be removed else 0
+ */
+static int isIdle(PT_RateClient pClient, unsigned long long now)
+{
+    double burst;
+    int type;
+
+    if (now - pClient->lastUs < RATE_IDLE_TIMEOUT * 1000000ULL)
+        return 0;
+
+    refill(pClient, now);
+    for (type = 0; type < RATE_TYPES; type++)
+    {
+        if (getLimit(type, &burst) > 0.0 && pClient->tokens[type] < burst)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Remove the idle clients of a slot of the hash table.
+ * @param ppClient Slot
+ * @param now Current time in microseconds
+ */
+static void removeIdle(PT_RateClient *ppClient, unsigned long long now)
+{
+    while (*ppClient)
+    {
+        PT_RateClient pClient = *ppClient;
+        if (isIdle(pClient, now))
+        {
+            *ppClient = pClient->pNext;
+            SYS_free(pClient);
+            numClients--;
+        }
+        else
+        {
+            ppClient = &pClient->pNext;
+        }
+    }
+}
+
+/****************************************************************************/
+
+/**
+ */
+void RATE_init(void)
+{
+    RATE_deinit();
+}
+
+/**
+ */
+void RATE_deinit(void)
+{
+    int i;
+    for (i = 0; i < RATE_TABLE_SIZE; i++)
+    {
+        while (table[i])
+        {
+            PT_RateClient pNext = table[i]->pNext;
+            SYS_free(table[i]);
+            table[i] = pNext;
+        }
+    }
+    numClients = 0;
+}
+
+/**
+ */
+int RATE_check(const char *pAddress, int type, int take)
+{
+    PT_RateClient *ppSlot;
+    PT_RateClient pClient;
+    unsigned long long now;
+    double burst;
+    double rate = getLimit(type, &burst);
+    int i;
+
+    if (rate <= 0.0)
+        return 0;
+
+    now = SYS_getMicroseconds();
+    ppSlot = &table[hashAddress(pAddress) & (RATE_TABLE_SIZE - 1)];
+    removeIdle(ppSlot, now);
+
+    pClient = *ppSlot;
+    while (pClient && strcmp(pClient->address, pAddress) != 0)
+        pClient = pClient->pNext;
+
+    if (pClient)
+    {
+        refill(pClient, now);
+    }
+    else
+    {
+        if (numClients >= RATE_MAX_CLIENTS)
+        {
+            for (i = 0; i < RATE_TABLE_SIZE; i++)
+                removeIdle(&table[i], now);
+        }
+
+        // clients without room are not limited
+        if (numClients >= RATE_MAX_CLIENTS)
+            return 0;
+        pClient = SYS_malloc(sizeof(T_RateClient));
+        if (!pClient)
+            return 0;
+
+        strncpy(pClient->address, pAddress, RATE_ADDRESS_SIZE - 1);
+        pClient->address[RATE_ADDRESS_SIZE - 1] = '\0';
+        pClient->lastUs = now;
+
+        // new clients start with full buckets
+        for (i = 0; i < RATE_TYPES; i++)
+            getLimit(i, &pClient->tokens[i]);
+        pClient->pNext = *ppSlot;
+        *ppSlot = pClient;
+        numClients++;
+    }
+
+    if (pClient->tokens[type] >= 1.0)
+    {
+        if (take)
+            pClient->tokens[type] -= 1.0;
+        return 0;
+    }
+
+    // seconds until the next token, rounded up
+    return (int)((1.0 - pClient->tokens[type]) / rate) + 1;
+}
+
+/**
+ */
+void RATE_giveBack(const char *pAddress, int type)
+{
+    PT_RateClient pClient = table[hashAddress(pAddress) & (RATE_TABLE_SIZE - 1)];
+    double burst;
+
+    while (pClient && strcmp(pClient->address, pAddress) != 0)
+        pClient = pClient->pNext;
+    if (!pClient || getLimit(type, &burst) <= 0.0)
+        return;
+
+    refill(pClient, SYS_getMicroseconds());
+    pClient->tokens[type] += 1.0;
+    if (pClient->tokens[type] > burst)
+        pClient->tokens[type] = burst;
+}
+
+/**
+ */
+int RATE_getCount(void)
+{
+    return numClients;
+}
+
+#endif // RATE_EN
@@ -0,0 +1,90 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file ratelimit.h
+ *  @brief Functions to limit the request rate of the clients.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _RATELIMIT_H_
+#define _RATELIMIT_H_
+
+#include "release.h"
+
+/**
+ * @defgroup RATE Rate limit
+ * @brief Token buckets limiting the request rate per client address.
+ *
+ * Each client address owns one bucket for the reads and one for the writes.
+ * A bucket holds up to "burst" tokens and is refilled with "rate" tokens per
+ * second, a request takes one token. The rates and bursts are set in the
+ * configuration file, a rate of 0 disables the limit.
+ *
+ * The buckets are stored in a hash table and are removed when a client has
+ * been idle for RATE_IDLE_TIMEOUT seconds and its buckets are full again.
+ * @{
+ */
+
+/** Bucket of the read requests */
+#define RATE_READ                   0
+
+/** Bucket of the write requests */
+#define RATE_WRITE                  1
+
+/** Number of buckets per client */
+#define RATE_TYPES                  2
+
+/**
+ * @brief Initialize the rate limit module.
+ */
+void RATE_init(void);
+
+/**
+ * @brief De-initialize the rate limit module.
+ * All buckets are removed.
+ */
+void RATE_deinit(void);
+
+/**
+ * @brief Check the bucket of a client and take a token.
+ * @param pAddress Client address (e.g. conn->remote_ip)
+ * @param type RATE_READ or RATE_WRITE
+ * @param take 1 to take a token when available, 0 to only check
+ * @return 0 if a token is available, else the number of seconds until
+ *         the next token is available
+ */
+int RATE_check(const char *pAddress, int type, int take);
+
+/**
+ * @brief Give back a token taken from the bucket of a client.
+ * Used when a request charged to one bucket turns out to belong to the other.
+ * @param pAddress Client address (e.g. conn->remote_ip)
+ * @param type RATE_READ or RATE_WRITE
+ */
+void RATE_giveBack(const char *pAddress, int type);
+
+/**
+ * @brief Get the number of clients with buckets.
+ * @return Number of clients
+ */
+int RATE_getCount(void);
+
+/** @} RATE */
+
+#endif // _RATELIMIT_H_
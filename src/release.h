@@ -47,7 +47,7 @@
 #define APP_NAME                            "OSC-webgate"
 
 /** Application version */
-#define APP_VERSION                         "1.1.0"
+#define APP_VERSION                         "1.2.0"
 
 /** Application file name*/
 #define APP_FILENAME                        "OSC-webgate"
@@ -64,6 +64,9 @@
 /** Buffer size of some configuration members */
 #define CONFIG_BUFFER_SIZE                  128
 
+/** Maximal number of osc_route lines in the configuration file */
+#define CONFIG_OSC_ROUTES_MAX               15
+
 /** Configuration structure for the Application */
 typedef struct t_AppConfig
 {
@@ -74,6 +77,20 @@ typedef struct t_AppConfig
     int  osc_port;                          /**< Port of the OSC host */
     char osc_host[CONFIG_BUFFER_SIZE];      /**< OSC host name or IP */
     char osc_prefix[CONFIG_BUFFER_SIZE];    /**< Prefix of variables routed to the OSC host */
+    char osc_routes[CONFIG_OSC_ROUTES_MAX][CONFIG_BUFFER_SIZE]; /**< Further OSC destinations ("prefix host port") */
+    int  osc_num_routes;                    /**< Number of further OSC destinations */
+    int  osc_window;                        /**< Time in milliseconds OSC messages are collected before they are sent */
+    int  osc_thread_cpu;                    /**< CPU of the OSC sender thread, -1 for any */
+    int  osc_thread_priority;               /**< SCHED_FIFO priority of the OSC sender thread, 0 for normal scheduling */
+    int  osc_listen_port;                   /**< UDP port receiving the OSC messages sent back by the OSC host, 0 to disable */
+    int  osc_hub_port;                      /**< UDP port receiving the OSC messages of controllers forwarded to the OSC host, 0 to disable */
+    char osc_hub_allow[CONFIG_BUFFER_SIZE]; /**< Controllers allowed to send to the hub port (names or IPs separated by spaces), empty for the local host */
+    int  osc_multicast_ttl;                 /**< TTL (hop limit) of the OSC packets sent to multicast groups */
+    char osc_multicast_if[CONFIG_BUFFER_SIZE]; /**< Interface (address or name) of the OSC packets sent to multicast groups, empty for the default */
+    int  limit_read_rate;                   /**< Read requests per second and client, 0 for no limit */
+    int  limit_read_burst;                  /**< Read requests a client can send at once */
+    int  limit_write_rate;                  /**< Write requests per second and client, 0 for no limit */
+    int  limit_write_burst;                 /**< Write requests a client can send at once */
 } T_AppConfig, *PT_AppConfig;
 
 extern T_AppConfig app;
@@ -160,10 +177,157 @@ extern T_AppConfig app;
 /** All variables with this default prefix are propagated to the OSC host */
 #define OSC_DEFAULT_PREFIX                  ""
 
+/** Default time in milliseconds OSC messages are collected before they are sent, 0 to send them at the end of the main loop iteration */
+#define OSC_DEFAULT_WINDOW                  0
+
+/** Maximal number of distinct OSC addresses collected before they are sent */
+#define OSC_QUEUE_SIZE                      128
+
+/** Enable/disable the thread sending the OSC packets (Linux only) */
+#ifdef LINUX
+  #define OSC_THREAD_EN                     1
+#else
+  #define OSC_THREAD_EN                     0
+#endif
+
+/** Enable/disable sending a batch of OSC packets with one sendmmsg() call (Linux only) */
+#ifdef LINUX
+  #define OSC_SENDMMSG_EN                   1
+#else
+  #define OSC_SENDMMSG_EN                   0
+#endif
+
+/** Maximal number of queued OSC packets sent with one system call */
+#define OSC_BATCH_SIZE                      64
+
+/** Size of the ring of packets queued to the sender thread in bytes, must be a power of 2 */
+#define OSC_RING_SIZE                       131072
+
+/** Enable/disable the listeners of the OSC messages of the OSC host and of controllers (needs OSC_EN) */
+#define OSCIN_EN                            OSC_EN
+
+/** Default UDP port receiving the OSC messages sent back by the OSC host, 0 to disable */
+#define OSCIN_DEFAULT_PORT                  0
+
+/** Default UDP port receiving the OSC messages of controllers forwarded to the OSC host, 0 to disable */
+#define OSCIN_DEFAULT_HUB_PORT              0
+
+/** Default TTL (hop limit) of the OSC packets sent to multicast groups, 1 stays in the local network */
+#define OSC_DEFAULT_MULTICAST_TTL           1
+
+/** Maximal number of OSC destinations with an open socket */
+#define OSC_MAX_DESTINATIONS                16
+
+/** Time in seconds after which the address of an OSC destination is resolved again */
+#define OSC_RESOLVE_INTERVAL                30
+
+/** Enable/disable OSC over TCP with SLIP framing to hosts named "tcp://host" (needs OSC_EN) */
+#define OSC_TCP_EN                          OSC_EN
+
+/** Maximal number of OSC hosts reached over TCP */
+#define OSC_TCP_MAX_DESTINATIONS            4
+
+/** Maximal number of packets queued per OSC host reached over TCP */
+#define OSC_TCP_QUEUE_SIZE                  256
+
+/** Number of bytes not sent yet above which the packets to an OSC host reached over TCP are queued */
+#define OSC_TCP_HIGH_WATER                  16384
+
+/** Time in seconds between the connection attempts to an OSC host reached over TCP */
+#define OSC_TCP_RECONNECT_INTERVAL          1
+
 /** @} CFG_OSC */
 
 /****************************************************************************/
 
+/**
+ * @defgroup CFG_CGI CGI
+ * @brief CGI module
+ * @{
+ */
+
+/** Enable/disable the cache for JSON read responses */
+#define CGI_CACHE_EN                        1
+
+/** Number of entries in the JSON response cache */
+#define CGI_CACHE_ENTRIES                   16
+
+/** Maximal size of a request or response stored in the JSON response cache */
+#define CGI_CACHE_MAX_SIZE                  8192
+
+/** Enable/disable parsing large JSON requests while they are received */
+#define CGI_STREAM_EN                       1
+
+/** Minimal size of a JSON request parsed while it is received */
+#define CGI_STREAM_MIN_SIZE                 16384
+
+/** Size from which the response to a streamed JSON request is sent */
+#define CGI_STREAM_FLUSH_SIZE               4096
+
+/** Maximal size of a pair and its value in a streamed JSON request */
+#define CGI_STREAM_PAIR_MAX                 4096
+
+/** Enable/disable the MessagePack request endpoint (msgpack.cgi) */
+#define CGI_MSGPACK_EN                      1
+
+/** @} CFG_CGI */
+
+/****************************************************************************/
+
+/**
+ * @defgroup CFG_PUSH Push
+ * @brief Push module
+ * @{
+ */
+
+/** Enable/disable code to push data-pool changes to web clients */
+#define PUSH_EN                             1
+
+/** @} CFG_PUSH */
+
+/****************************************************************************/
+
+/**
+ * @defgroup CFG_SESSION Session
+ * @brief Session module
+ * @{
+ */
+
+/** Enable/disable code for read subscriptions polled by session id (json.cgi) */
+#define SESSION_EN                          1
+
+/** Maximal number of sessions */
+#define SESSION_MAX_SESSIONS                64
+
+/** Time in seconds after which an unused session expires */
+#define SESSION_TIMEOUT                     60
+
+/** @} CFG_SESSION */
+
+/****************************************************************************/
+
+/**
+ * @defgroup CFG_RATE Rate limit
+ * @brief Rate limit module
+ * @{
+ */
+
+/** Enable/disable code to limit the request rate per client address */
+#define RATE_EN                             1
+
+/** Size of the hash table of the clients, must be a power of 2 */
+#define RATE_TABLE_SIZE                     256
+
+/** Maximal number of clients with buckets */
+#define RATE_MAX_CLIENTS                    1024
+
+/** Time in seconds after which an idle client with full buckets is removed */
+#define RATE_IDLE_TIMEOUT                   60
+
+/** @} CFG_RATE */
+
+/****************************************************************************/
+
 /**
  * @defgroup CFG_MEMORY Memory Management
  * @brief Memory management
@@ -0,0 +1,301 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "route.h"
+#include "radix.h"
+#include "ratelimit.h"
+#include "utils.h"
+
+/****************************************************************************/
+
+/** Maximal number of routes */
+#define ROUTE_MAX_ROUTES            32
+
+/** @brief Registered route with its statistics */
+typedef struct t_RouteEntry
+{
+    const T_Route *pRoute;          /**< route */
+    T_RouteStats stats;             /**< statistics */
+} T_RouteEntry, *PT_RouteEntry;
+
+/** @brief Method names and flags */
+static const struct
+{
+    const char *pName;              /**< method name */
+    int flag;                       /**< method flag */
+} methods[] =
+{
+    { "GET", ROUTE_GET },
+    { "POST", ROUTE_POST },
+    { "PUT", ROUTE_PUT },
+    { "DELETE", ROUTE_DELETE },
+    { "HEAD", ROUTE_HEAD },
+    { "OPTIONS", ROUTE_OPTIONS },
+    { NULL, 0 }
+};
+
+/****************************************************************************/
+
+/** Root of the radix trie of the paths, its label is empty */
+static T_RadixNode root;
+
+/** Registered routes */
+static T_RouteEntry entries[ROUTE_MAX_ROUTES];
+
+/** Number of registered routes */
+static int numEntries = 0;
+
+/****************************************************************************/
+
+/**
+ * @brief Get the flag of the method of a request.
+ * @param pMethod Method name
+ * @return Method flag, 0 if unknown
+ */
+static int getMethod(const char *pMethod)
+{
+    int i;
+    for (i = 0; methods[i].pName; i++)
+    {
+        if (strcmp(methods[i].pName, pMethod) == 0)
+            return methods[i].flag;
+    }
+    return 0;
+}
+
+/**
+ * @brief Answer a request with a method not allowed by its route.
+ * @param conn HTTP connection
+ * @param allowed Allowed methods
+ */
+static void sendMethodNotAllowed(struct mg_connection *conn, int allowed)
+{
+    char allow[64] = "";
+    int i;
+
+    for (i = 0; methods[i].pName; i++)
+    {
+        if (allowed & methods[i].flag)
+        {
+            if (*allow)
+                strcat(allow, ", ");
+            strcat(allow, methods[i].pName);
+        }
+    }
+    mg_send_status(conn, 405);
+    mg_send_header(conn, "Allow", allow);
+    mg_send_data(conn, "", 0);
+}
+
+#if RATE_EN
+/**
+ * @brief Check the rate limit of a request.
+ * @param conn HTTP connection
+ * @param pRoute Route of the request
+ * @param take 1 to take a token when available, 0 to only check
+ * @return 0 if the request is allowed, else the number of seconds to wait
+ */
+static int checkLimit(struct mg_connection *conn, const T_Route *pRoute, int take)
+{
+    if (pRoute->limit == ROUTE_LIMIT_NONE)
+        return 0;
+    return RATE_check(conn->remote_ip, pRoute->limit == ROUTE_LIMIT_READ ? RATE_READ : RATE_WRITE, take);
+}
+#endif
+
+/**
+ * @brief Add the time spent in a handler to the statistics of a route.
+ * @param pEntry Route
+ * @param start Time stamp taken before the handler was called
+ */
+static void addTime(PT_RouteEntry pEntry, unsigned long long start)
+{
+    unsigned long us = (unsigned long)(SYS_getMicroseconds() - start);
+    pEntry->stats.totalUs += us;
+    if (us > pEntry->stats.maxUs)
+        pEntry->stats.maxUs = us;
+}
+
+/****************************************************************************/
+
+/**
+ */
+void ROUTE_init(void)
+{
+    ROUTE_deinit();
+}
+
+/**
+ */
+void ROUTE_deinit(void)
+{
+    RADIX_free(&root);
+    numEntries = 0;
+}
+
+/**
+ */
+int ROUTE_register(const T_Route *pRoute)
+{
+    PT_RadixNode pNode;
+    PT_RouteEntry pEntry;
+
+    if (numEntries == ROUTE_MAX_ROUTES)
+        return -1;
+
+    pNode = RADIX_insert(&root, pRoute->pPath);
+    if (!pNode || pNode->pValue)
+        return -1;
+
+    pEntry = &entries[numEntries++];
+    memset(pEntry, 0, sizeof(T_RouteEntry));
+    pEntry->pRoute = pRoute;
+    pEntry->stats.pPath = pRoute->pPath;
+    pNode->pValue = pEntry;
+    return 0;
+}
+
+/**
+ */
+const T_Route* ROUTE_find(const char *pPath)
+{
+    PT_RouteEntry pEntry = (PT_RouteEntry)RADIX_find(&root, pPath);
+    return pEntry ? pEntry->pRoute : NULL;
+}
+
+/**
+ */
+int ROUTE_handleEvent(struct mg_connection *conn, enum mg_event ev)
+{
+    PT_RouteEntry pEntry;
+    const T_Route *pRoute;
+    unsigned long long start;
+    int ret;
+  #if RATE_EN
+    int wait;
+  #endif
+
+    if (!conn->uri)
+        return MG_FALSE;
+
+    // only connections with state are polled or closed
+    if ((ev == MG_POLL || ev == MG_CLOSE) && !conn->connection_param)
+        return MG_FALSE;
+
+    if (ev != MG_REQUEST && ev != MG_RECV && ev != MG_POLL && ev != MG_CLOSE)
+        return MG_FALSE;
+
+    pEntry = (PT_RouteEntry)RADIX_find(&root, conn->uri);
+    if (!pEntry)
+    {
+        if (ev == MG_REQUEST && strncmp(conn->uri, ROUTE_CGI_PATH, strlen(ROUTE_CGI_PATH)) == 0)
+        {
+            // send forbidden status code
+            mg_send_status(conn, 403);
+            mg_send_data(conn, "", 0);
+            return MG_TRUE;
+        }
+        return ev == MG_RECV ? 0 : MG_FALSE;
+    }
+    pRoute = pEntry->pRoute;
+
+    switch (ev)
+    {
+        case MG_REQUEST:
+            if (!(getMethod(conn->request_method) & pRoute->methods))
+            {
+                pEntry->stats.rejected++;
+                sendMethodNotAllowed(conn, pRoute->methods);
+                return MG_TRUE;
+            }
+          #if RATE_EN
+            // a streamed request took its token when it was received
+            if (!conn->connection_param && (wait = checkLimit(conn, pRoute, 1)) != 0)
+            {
+                ROUTE_sendTooManyRequests(conn, wait);
+                return MG_TRUE;
+            }
+          #endif
+            pEntry->stats.requests++;
+            start = SYS_getMicroseconds();
+            ret = pRoute->request(conn);
+            addTime(pEntry, start);
+            return ret;
+
+        case MG_RECV:
+            if (!pRoute->recv || !(getMethod(conn->request_method) & pRoute->methods))
+                return 0;
+          #if RATE_EN
+            if (!conn->connection_param)
+            {
+                // without token the request is buffered and rejected on MG_REQUEST
+                if (checkLimit(conn, pRoute, 0) != 0)
+                    return 0;
+                start = SYS_getMicroseconds();
+                ret = pRoute->recv(conn);
+                addTime(pEntry, start);
+                if (conn->connection_param)
+                    checkLimit(conn, pRoute, 1);
+                return ret;
+            }
+          #endif
+            start = SYS_getMicroseconds();
+            ret = pRoute->recv(conn);
+            addTime(pEntry, start);
+            return ret;
+
+        case MG_POLL:
+            return pRoute->poll ? pRoute->poll(conn) : MG_FALSE;
+
+        case MG_CLOSE:
+            if (pRoute->close)
+                pRoute->close(conn);
+            return MG_FALSE;
+
+        default:
+            return MG_FALSE;
+    }
+}
+
+/**
+ */
+void ROUTE_sendTooManyRequests(struct mg_connection *conn, int seconds)
+{
+    PT_RouteEntry pEntry = (PT_RouteEntry)RADIX_find(&root, conn->uri);
+    char retry[16];
+
+    if (pEntry)
+        pEntry->stats.throttled++;
+
+    snprintf(retry, sizeof(retry), "%d", seconds);
+    mg_send_status(conn, 429);
+    mg_send_header(conn, "Retry-After", retry);
+    mg_send_data(conn, "", 0);
+}
+
+/**
+ */
+int ROUTE_getStats(int index, PT_RouteStats pStats)
+{
+    if (index < 0 || index >= numEntries)
+        return -1;
+    *pStats = entries[index].stats;
+    return 0;
+}
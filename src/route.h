@@ -0,0 +1,159 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file route.h
+ *  @brief Functions to dispatch HTTP requests to registered handlers.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _ROUTE_H_
+#define _ROUTE_H_
+
+#include "release.h"
+#include "mongoose.h"
+
+/**
+ * @defgroup ROUTE Route
+ * @brief Dispatches HTTP requests to the handlers registered by the modules.
+ *
+ * Modules register their endpoints with ROUTE_register(), usually in their
+ * initialization function. The paths are stored in a radix trie (see
+ * @ref RADIX), so finding the route of a request costs O(length of the
+ * path) whatever the number of routes.
+ *
+ * A request with a method not allowed by its route is answered with
+ * "405 Method Not Allowed". A request below ROUTE_CGI_PATH without route is
+ * answered with "403 Forbidden", other requests are left to the web-server
+ * (static files).
+ *
+ * Requests of routes with a rate limit take a token of the read or write
+ * bucket of the client address (see @ref RATE), a request without token is
+ * answered with "429 Too Many Requests". A route serving reads and writes
+ * is limited by the read rate, its handler swaps the read token for a write
+ * token when it finds a write and answers with ROUTE_sendTooManyRequests()
+ * if there is none. A request parsed while it is received takes its token when the recv
+ * handler sets the connection_param.
+ *
+ * The number of requests and the time spent in the handlers are recorded
+ * per route (see ROUTE_getStats()).
+ * @{
+ */
+
+/** Path of the CGI requests */
+#define ROUTE_CGI_PATH              "/cgi-bin/"
+
+/** Method GET */
+#define ROUTE_GET                   0x01
+/** Method POST */
+#define ROUTE_POST                  0x02
+/** Method PUT */
+#define ROUTE_PUT                   0x04
+/** Method DELETE */
+#define ROUTE_DELETE                0x08
+/** Method HEAD */
+#define ROUTE_HEAD                  0x10
+/** Method OPTIONS */
+#define ROUTE_OPTIONS               0x20
+/** All methods */
+#define ROUTE_ANY                   0x3F
+
+/** No rate limit */
+#define ROUTE_LIMIT_NONE            0
+/** Requests limited by the read rate */
+#define ROUTE_LIMIT_READ            1
+/** Requests limited by the write rate */
+#define ROUTE_LIMIT_WRITE           2
+
+/** @brief Description of a route, registered once and never copied */
+typedef struct t_Route
+{
+    const char *pPath;                              /**< path, e.g. "/cgi-bin/json.cgi" */
+    int methods;                                    /**< allowed methods (ROUTE_GET, ...) */
+    int limit;                                      /**< rate limit (ROUTE_LIMIT_NONE, ROUTE_LIMIT_READ or ROUTE_LIMIT_WRITE) */
+    int (*request)(struct mg_connection *conn);     /**< handles a request (MG_REQUEST), returns MG_TRUE or MG_MORE */
+    int (*recv)(struct mg_connection *conn);        /**< handles received data (MG_RECV), returns the bytes consumed, can be NULL */
+    int (*poll)(struct mg_connection *conn);        /**< polls a connection with a connection_param (MG_POLL), returns MG_TRUE to close it, can be NULL */
+    void (*close)(struct mg_connection *conn);      /**< releases the connection_param of a closed connection (MG_CLOSE), can be NULL */
+} T_Route, *PT_Route;
+
+/** @brief Statistics of a route */
+typedef struct t_RouteStats
+{
+    const char *pPath;              /**< path of the route */
+    unsigned long requests;         /**< number of requests handled */
+    unsigned long rejected;         /**< number of requests with a method not allowed */
+    unsigned long throttled;        /**< number of requests over the rate limit */
+    unsigned long long totalUs;     /**< time spent in the handlers in microseconds */
+    unsigned long maxUs;            /**< longest time spent in a handler in microseconds */
+} T_RouteStats, *PT_RouteStats;
+
+/**
+ * @brief Initialize the route module.
+ * Call this function before the modules register their routes.
+ */
+void ROUTE_init(void);
+
+/**
+ * @brief De-initialize the route module.
+ * All routes are removed.
+ */
+void ROUTE_deinit(void);
+
+/**
+ * @brief Register a route.
+ * @param pRoute Route, must stay valid until ROUTE_deinit() is called
+ * @return 0 on success, -1 if the path is already registered or out of memory
+ */
+int ROUTE_register(const T_Route *pRoute);
+
+/**
+ * @brief Find the route of a path.
+ * @param pPath Path without query string
+ * @return Route or NULL if not found
+ */
+const T_Route* ROUTE_find(const char *pPath);
+
+/**
+ * @brief Dispatch a web-server event to the route of the connection.
+ * Call this function from the event handler of the web-server.
+ * @param conn HTTP connection
+ * @param ev Event number
+ * @return Result of the event (see mongoose documentation)
+ */
+int ROUTE_handleEvent(struct mg_connection *conn, enum mg_event ev);
+
+/**
+ * @brief Answer a request over the rate limit with "429 Too Many Requests".
+ * The request is counted in the statistics of its route.
+ * @param conn HTTP connection
+ * @param seconds Seconds until the next request is allowed
+ */
+void ROUTE_sendTooManyRequests(struct mg_connection *conn, int seconds);
+
+/**
+ * @brief Get the statistics of a route.
+ * @param index Index of the route, in the order of registration
+ * @param pStats Structure receiving the statistics
+ * @return 0 on success, -1 if there is no route with this index
+ */
+int ROUTE_getStats(int index, PT_RouteStats pStats);
+
+/** @} ROUTE */
+
+#endif // _ROUTE_H_
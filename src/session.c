@@ -0,0 +1,261 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include "session.h"
+
+#if SESSION_EN
+
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+/****************************************************************************/
+
+/** Sessions */
+static T_Session sessions[SESSION_MAX_SESSIONS];
+
+/** Counter used to compute session ids */
+static unsigned int idCounter = 0;
+
+/****************************************************************************/
+
+/**
+ * @brief Append a handle to the handles of a session.
+ * @param pSession Session
+ * @param handle Handle of the variable
+ * @return 0 on success, -1 if out of memory
+ */
+static int addHandle(PT_Session pSession, DP_HANDLE handle)
+{
+    if (pSession->numHandles == pSession->maxHandles)
+    {
+        int maxHandles = pSession->maxHandles ? pSession->maxHandles * 2 : 16;
+        DP_HANDLE *pHandles = SYS_realloc(pSession->pHandles, maxHandles * sizeof(DP_HANDLE));
+        if (!pHandles)
+            return -1;
+        pSession->pHandles = pHandles;
+        pSession->maxHandles = maxHandles;
+    }
+    pSession->pHandles[pSession->numHandles++] = handle;
+    return 0;
+}
+
+/**
+ * @brief Check if a variable is subscribed by name.
+ * @param pSession Session
+ * @param handle Handle of the variable
+ * @return 1 if subscribed by name
+ */
+static int isVariable(PT_Session pSession, DP_HANDLE handle)
+{
+    int i;
+    for (i = 0; i < pSession->numVariables; i++)
+    {
+        if (pSession->pHandles[i] == handle)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Resolve the prefixes of a session against the data-pool.
+ * The handles of variables subscribed by name are kept.
+ * @param pSession Session
+ * @return 0 on success, -1 if out of memory
+ */
+static int resolvePrefixes(PT_Session pSession)
+{
+    DP_HANDLE handle = NULL;
+
+    pSession->numHandles = pSession->numVariables;
+    pSession->count = DP_getCount();
+    if (pSession->prefixes.len == 0)
+        return 0;
+
+    while ((handle = DP_getNext(handle)) != NULL)
+    {
+        const char *pVariable = DP_getVariable(handle);
+        const char *pPrefix = pSession->prefixes.pData;
+        const char *pEnd = pPrefix + pSession->prefixes.len;
+
+        while (pPrefix < pEnd)
+        {
+            size_t len = strlen(pPrefix);
+            if (strncmp(pPrefix, pVariable, len) == 0)
+            {
+                if (!isVariable(pSession, handle) && addHandle(pSession, handle))
+                    return -1;
+                break;
+            }
+            pPrefix += len + 1;
+        }
+    }
+    return 0;
+}
+
+/****************************************************************************/
+
+/**
+ */
+void SESSION_deinit(void)
+{
+    int i;
+    for (i = 0; i < SESSION_MAX_SESSIONS; i++)
+    {
+        SESSION_remove(&sessions[i]);
+        SYS_free(sessions[i].pHandles);
+        sessions[i].pHandles = NULL;
+        sessions[i].maxHandles = 0;
+        STRBUF_free(&sessions[i].volatiles);
+        STRBUF_free(&sessions[i].prefixes);
+    }
+}
+
+/**
+ */
+PT_Session SESSION_create(void)
+{
+    PT_Session pSession = &sessions[0];
+    time_t now = time(NULL);
+    unsigned int id;
+    int i;
+
+    // take a free session or replace the least recently used one
+    for (i = 0; i < SESSION_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].id && now - sessions[i].lastUsed > SESSION_TIMEOUT)
+            SESSION_remove(&sessions[i]);
+        if (sessions[i].id == 0)
+        {
+            if (pSession->id)
+                pSession = &sessions[i];
+        }
+        else if (pSession->id && sessions[i].lastUsed < pSession->lastUsed)
+        {
+            pSession = &sessions[i];
+        }
+    }
+    SESSION_remove(pSession);
+
+    // ids are hard to guess and never 0 or equal to an active id
+    do
+    {
+        idCounter++;
+        id = str_hashAppend(str_hash(&now, sizeof(now)), &idCounter, sizeof(idCounter));
+        id = str_hashAppend(id, &pSession, sizeof(pSession));
+    } while (id == 0 || SESSION_find(id));
+
+    pSession->id = id;
+    pSession->lastUsed = now;
+    pSession->count = DP_getCount();
+    return pSession;
+}
+
+/**
+ */
+int SESSION_addVariable(PT_Session pSession, const char *pVariable)
+{
+    DP_HANDLE handle = DP_getHandle(pVariable);
+
+    if (!handle)
+    {
+        if (!DP_isVolatile(pVariable))
+            return 0;
+        return STRBUF_append(&pSession->volatiles, pVariable, strlen(pVariable) + 1);
+    }
+
+    if (isVariable(pSession, handle))
+        return 0;
+
+    // keep the handles subscribed by name in front of the prefix matches
+    pSession->numHandles = pSession->numVariables;
+    if (addHandle(pSession, handle))
+        return -1;
+    pSession->numVariables++;
+    return resolvePrefixes(pSession);
+}
+
+/**
+ */
+int SESSION_addPrefix(PT_Session pSession, const char *pPrefix)
+{
+    if (STRBUF_append(&pSession->prefixes, pPrefix, strlen(pPrefix) + 1))
+        return -1;
+    return resolvePrefixes(pSession);
+}
+
+/**
+ */
+PT_Session SESSION_find(unsigned int id)
+{
+    time_t now = time(NULL);
+    int i;
+
+    if (id == 0)
+        return NULL;
+
+    for (i = 0; i < SESSION_MAX_SESSIONS; i++)
+    {
+        PT_Session pSession = &sessions[i];
+        if (pSession->id != id)
+            continue;
+
+        if (now - pSession->lastUsed > SESSION_TIMEOUT)
+        {
+            SESSION_remove(pSession);
+            return NULL;
+        }
+        pSession->lastUsed = now;
+
+        // variables were added to the data-pool
+        if (pSession->count != DP_getCount() && resolvePrefixes(pSession))
+        {
+            SESSION_remove(pSession);
+            return NULL;
+        }
+        return pSession;
+    }
+    return NULL;
+}
+
+/**
+ */
+void SESSION_remove(PT_Session pSession)
+{
+    pSession->id = 0;
+    pSession->numHandles = 0;
+    pSession->numVariables = 0;
+    STRBUF_reset(&pSession->volatiles);
+    STRBUF_reset(&pSession->prefixes);
+}
+
+/**
+ */
+int SESSION_getCount(void)
+{
+    time_t now = time(NULL);
+    int i, count = 0;
+
+    for (i = 0; i < SESSION_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].id && now - sessions[i].lastUsed <= SESSION_TIMEOUT)
+            count++;
+    }
+    return count;
+}
+
+#endif // SESSION_EN
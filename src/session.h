@@ -0,0 +1,115 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+/**
+ *  @file session.h
+ *  @brief Functions to manage the read subscriptions of web clients.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _SESSION_H_
+#define _SESSION_H_
+
+#include <time.h>
+#include "release.h"
+#include "datapool.h"
+#include "strbuf.h"
+
+/**
+ * @defgroup SESSION Session
+ * @brief Read subscriptions registered once and polled by id.
+ *
+ * A session holds the variables and prefixes a web client subscribed to.
+ * Variables of the data-pool are stored as an array of handles, volatile
+ * variables (see DP_isVolatile()) by name. Prefixes are resolved against
+ * the data-pool when the session is created and again when variables were
+ * added to the data-pool since then.
+ *
+ * Sessions not used for SESSION_TIMEOUT seconds expire. If all
+ * SESSION_MAX_SESSIONS sessions are in use, the least recently used one is
+ * replaced.
+ * @{
+ */
+
+/** @brief Structure for a session */
+typedef struct t_Session
+{
+    unsigned int id;                /**< session id, 0 if the session is free */
+    time_t lastUsed;                /**< time of the last use */
+    unsigned long count;            /**< data-pool size when the prefixes were resolved */
+    DP_HANDLE *pHandles;            /**< subscribed variables with a handle */
+    int numHandles;                 /**< number of handles */
+    int numVariables;               /**< number of handles subscribed by name, the others by prefix */
+    int maxHandles;                 /**< number of allocated handles */
+    T_StrBuf volatiles;             /**< subscribed volatile variables ('\0' separated) */
+    T_StrBuf prefixes;              /**< subscribed prefixes ('\0' separated) */
+} T_Session, *PT_Session;
+
+/**
+ * @brief Release all sessions.
+ */
+void SESSION_deinit(void);
+
+/**
+ * @brief Create a new session.
+ * Expired sessions are released first.
+ * @return New session without any variable or NULL if out of memory
+ */
+PT_Session SESSION_create(void);
+
+/**
+ * @brief Subscribe a session to a variable.
+ * Call this function and SESSION_addPrefix() right after SESSION_create().
+ * @param pSession Session
+ * @param pVariable Variable name
+ * @return 0 on success, -1 if out of memory
+ */
+int SESSION_addVariable(PT_Session pSession, const char *pVariable);
+
+/**
+ * @brief Subscribe a session to all variables starting with a prefix.
+ * Only variables of the data-pool are matched, not the volatile ones.
+ * @param pSession Session
+ * @param pPrefix Prefix
+ * @return 0 on success, -1 if out of memory
+ */
+int SESSION_addPrefix(PT_Session pSession, const char *pPrefix);
+
+/**
+ * @brief Find a session by its id.
+ * The session is marked as used and its prefixes are resolved again if
+ * variables were added to the data-pool.
+ * @param id Session id
+ * @return Session or NULL if unknown or expired
+ */
+PT_Session SESSION_find(unsigned int id);
+
+/**
+ * @brief Release a session.
+ * @param pSession Session
+ */
+void SESSION_remove(PT_Session pSession);
+
+/**
+ * @brief Get the number of active sessions.
+ * @return Number of sessions
+ */
+int SESSION_getCount(void);
+
+/** @} SESSION */
+
+#endif // _SESSION_H_
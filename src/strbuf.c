@@ -0,0 +1,187 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "release.h"
+#include "strbuf.h"
+
+/****************************************************************************/
+
+/** Repeat a byte in all bytes of a 64-bit word */
+#define STRBUF_REPEAT(b)            ((uint64_t)(b) * 0x0101010101010101ULL)
+
+/****************************************************************************/
+
+/**
+ * @brief Check 8 bytes for a character which must be escaped in a JSON string.
+ * @param w 8 bytes
+ * @return Not 0 if a byte is lower than 0x20, a quote or a backslash
+ */
+static uint64_t needsEscape(uint64_t w)
+{
+    uint64_t quote = w ^ STRBUF_REPEAT('"');
+    uint64_t backslash = w ^ STRBUF_REPEAT('\\');
+
+    // a byte lower than n sets its high bit in (w - n) & ~w (n <= 0x80)
+    return (((w - STRBUF_REPEAT(0x20)) & ~w) |
+            ((quote - STRBUF_REPEAT(0x01)) & ~quote) |
+            ((backslash - STRBUF_REPEAT(0x01)) & ~backslash)) & STRBUF_REPEAT(0x80);
+}
+
+/****************************************************************************/
+
+/**
+ */
+void STRBUF_init(PT_StrBuf pBuf)
+{
+    pBuf->pData = NULL;
+    pBuf->len = 0;
+    pBuf->size = 0;
+}
+
+/**
+ */
+void STRBUF_free(PT_StrBuf pBuf)
+{
+    SYS_free(pBuf->pData);
+    STRBUF_init(pBuf);
+}
+
+/**
+ */
+void STRBUF_reset(PT_StrBuf pBuf)
+{
+    pBuf->len = 0;
+    if (pBuf->pData)
+        *pBuf->pData = '\0';
+}
+
+/**
+ */
+int STRBUF_reserve(PT_StrBuf pBuf, size_t len)
+{
+    char *pData;
+    size_t size;
+
+    // one more byte for the terminating '\0'
+    if (pBuf->len + len + 1 <= pBuf->size)
+        return 0;
+
+    // grow by doubling the size
+    size = pBuf->size ? pBuf->size : STRBUF_MIN_SIZE;
+    while (size < pBuf->len + len + 1)
+        size *= 2;
+
+    pData = SYS_realloc(pBuf->pData, size);
+    if (!pData)
+        return -1;
+    pBuf->pData = pData;
+    pBuf->size = size;
+    return 0;
+}
+
+/**
+ */
+int STRBUF_append(PT_StrBuf pBuf, const void *pData, size_t len)
+{
+    if (STRBUF_reserve(pBuf, len))
+        return -1;
+    memcpy(pBuf->pData + pBuf->len, pData, len);
+    pBuf->len += len;
+    pBuf->pData[pBuf->len] = '\0';
+    return 0;
+}
+
+/**
+ */
+int STRBUF_appendStr(PT_StrBuf pBuf, const char *pStr)
+{
+    return STRBUF_append(pBuf, pStr, strlen(pStr));
+}
+
+/**
+ */
+int STRBUF_appendJsonString(PT_StrBuf pBuf, const char *pStr, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    char esc[6] = { '\\', 0, '0', '0', 0, 0 };
+    size_t start = 0, i = 0, escLen;
+
+    while (i < len)
+    {
+        unsigned char c;
+
+        // skip 8 bytes which need no escaping
+        if (i + 8 <= len)
+        {
+            uint64_t w;
+            memcpy(&w, pStr + i, 8);
+            if (!needsEscape(w))
+            {
+                i += 8;
+                continue;
+            }
+        }
+
+        c = (unsigned char)pStr[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            i++;
+            continue;
+        }
+
+        // copy the span which needs no escaping, then the escaped character
+        if (STRBUF_append(pBuf, pStr + start, i - start))
+            return -1;
+        esc[1] = c;
+        escLen = 2;
+        switch (c)
+        {
+            case '"':
+            case '\\':
+                break;
+            case '\b':
+                esc[1] = 'b';
+                break;
+            case '\f':
+                esc[1] = 'f';
+                break;
+            case '\n':
+                esc[1] = 'n';
+                break;
+            case '\r':
+                esc[1] = 'r';
+                break;
+            case '\t':
+                esc[1] = 't';
+                break;
+            default:
+                esc[1] = 'u';
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 0xF];
+                escLen = 6;
+                break;
+        }
+        if (STRBUF_append(pBuf, esc, escLen))
+            return -1;
+        start = ++i;
+    }
+
+    return STRBUF_append(pBuf, pStr + start, len - start);
+}
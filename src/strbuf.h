@@ -0,0 +1,118 @@
+/****************************************************************************
+ *   This file is part of OSC-webgate.                                      *
+ *                                                                          *
+ *   OSC-webgate is free software: you can redistribute it and/or           *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation, either version 3 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   OSC-webgate is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
+ ****************************************************************************/
+
+/**
+ *  @file strbuf.h
+ *  @brief Growable string buffer.
+ *  @version 1.0
+ *  @date 19 Oct 2026
+ */
+
+#ifndef _STRBUF_H_
+#define _STRBUF_H_
+
+#include <stddef.h>
+
+/**
+ * @addtogroup UTILITIES
+ * @{
+ */
+
+/**
+ * @defgroup STRBUF String Buffer
+ * @brief Growable string buffer.
+ *
+ * A string buffer grows on demand and keeps its memory when it is reset,
+ * so a buffer that is reused for every request allocates only until it
+ * reached the size of the biggest request.
+ *
+ * The content is always terminated by a '\\0' character which is not
+ * counted in the length.
+ * @{
+ */
+
+/** Minimal allocation size of a string buffer */
+#define STRBUF_MIN_SIZE             256
+
+/** @brief String buffer structure */
+typedef struct t_StrBuf
+{
+    char   *pData;                  /**< buffer, NULL if nothing allocated */
+    size_t len;                     /**< number of bytes used */
+    size_t size;                    /**< number of bytes allocated */
+} T_StrBuf, *PT_StrBuf;
+
+/**
+ * @brief Initialize an empty string buffer. No memory is allocated.
+ * @param pBuf String buffer
+ */
+void STRBUF_init(PT_StrBuf pBuf);
+
+/**
+ * @brief Free the memory of a string buffer.
+ * @param pBuf String buffer
+ */
+void STRBUF_free(PT_StrBuf pBuf);
+
+/**
+ * @brief Empty a string buffer but keep its memory.
+ * @param pBuf String buffer
+ */
+void STRBUF_reset(PT_StrBuf pBuf);
+
+/**
+ * @brief Make sure a certain amount of bytes can be appended.
+ * @param pBuf String buffer
+ * @param len Number of bytes
+ * @return 0 on success, -1 if out of memory
+ */
+int STRBUF_reserve(PT_StrBuf pBuf, size_t len);
+
+/**
+ * @brief Append data to a string buffer.
+ * @param pBuf String buffer
+ * @param pData Data to append
+ * @param len Length of the data
+ * @return 0 on success, -1 if out of memory
+ */
+int STRBUF_append(PT_StrBuf pBuf, const void *pData, size_t len);
+
+/**
+ * @brief Append a string to a string buffer.
+ * @param pBuf String buffer
+ * @param pStr String to append
+ * @return 0 on success, -1 if out of memory
+ */
+int STRBUF_appendStr(PT_StrBuf pBuf, const char *pStr);
+
+/**
+ * @brief Append a string escaped for a JSON string (without the quotes).
+ * Quotes, backslashes and control characters are escaped, everything else
+ * is copied as is. The string is scanned 8 bytes at a time and the spans
+ * which need no escaping are copied at once.
+ * @param pBuf String buffer
+ * @param pStr String to append
+ * @param len Length of the string
+ * @return 0 on success, -1 if out of memory
+ */
+int STRBUF_appendJsonString(PT_StrBuf pBuf, const char *pStr, size_t len);
+
+/** @} STRBUF */
+
+/** @} UTILITIES */
+
+#endif // _STRBUF_H_
@@ -17,257 +17,850 @@
  *   along with OSC-webgate. If not, see <http://www.gnu.org/licenses/>.    *
  ****************************************************************************/
 
-#include <ctype.h>
 #include <string.h>
 #include "ujsonpars.h"
 
+#if UJSON_SIMD_EN && defined(__GNUC__)
+  #if defined(__SSE2__)
+    #include <emmintrin.h>
+    #define UJSON_SSE2
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define UJSON_NEON
+  #endif
+#endif
+
 /****************************************************************************/
 
-/** Parsing state of a JSON file */
-typedef enum t_UJSON_State
+/** Maximal nesting depth of objects and arrays */
+#define UJSON_DEPTH_MAX             (int)(8 * sizeof(unsigned long))
+
+/** Maximal length of a value at the end of the data which is not a string */
+#define UJSON_SCALAR_SIZE           64
+
+/** Check for a white space */
+#define UJSON_IS_SPACE(c)           ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r' || (c) == '\v' || (c) == '\f')
+
+/** Inline the scanning functions (the class is a constant), not the decoding of escape sequences */
+#if defined(__GNUC__)
+  #define UJSON_INLINE              static inline __attribute__((always_inline))
+  #define UJSON_NOINLINE            static __attribute__((noinline))
+#else
+  #define UJSON_INLINE              static
+  #define UJSON_NOINLINE            static
+#endif
+
+/** Size of a block scanned with SIMD instructions */
+#define UJSON_BLOCK_SIZE            16
+
+/** @brief Classes of characters searched by findClass() */
+typedef enum t_UJSON_Class
 {
-    UJSON_ST_NONE,                      /**< parsing nothing */
-    UJSON_ST_VALUE,                     /**< parsing a value */
-    UJSON_ST_ARRAY                      /**< parsing an array */
-} T_UJSON_State, *PT_UJSON_State;
+    UJSON_CL_STRING,                    /**< '"' or '\\' */
+    UJSON_CL_DELIMITER,                 /**< '{', '}', '[', ']' or ',' */
+    UJSON_CL_TOKEN                      /**< not a white space */
+} T_UJSON_Class;
 
 /****************************************************************************/
 
 /**
  * @brief Get the next character by calling the callback function getChar().
- * If a character was "unget" the function will return this character.
  * @param pJson JSON parsing structure
- * @return Next character
+ * @return Next character, -1 at the end of the data
  */
 static int getChar(PT_uJson pJson)
 {
     int c;
 
-    // check if end of file/buffer
-    if (pJson->eof)
-        return -1;
-
-    // check for an "unget" character
-    if (pJson->unget_c != -1)
-    {
-        c = pJson->unget_c;
-        pJson->unget_c = -1;
-        return c;
-    }
-
     // check if the maximal read count is reached
     if (pJson->readCnt == pJson->maxReadCnt)
-    {
-        pJson->eof = 1;
         return -1;
-    }
 
     // get next character from callback function
     c = pJson->getChar(pJson);
     pJson->readCnt++;
-
-    // check if end of file/buffer
-    if (c == -1)
-        pJson->eof = 1;
-
     return c;
 }
 
+#if defined(UJSON_SSE2) || defined(UJSON_NEON)
+
 /**
- * @brief "Unget" a character. See getChar().
- * @param pJson JSON parsing structure
- * @param c Character to "unget"
+ * @brief Check if a character belongs to a class.
+ * @param c Character
+ * @param cl Class
+ * @return 1 if the character belongs to the class
  */
-static void ungetChar(PT_uJson pJson, int c)
+UJSON_INLINE int isClass(char c, T_UJSON_Class cl)
 {
-    if (pJson->eof)
-        return;
-    pJson->unget_c = c;
+    switch (cl)
+    {
+        case UJSON_CL_STRING:
+            return c == '"' || c == '\\';
+        case UJSON_CL_DELIMITER:
+            return c == '{' || c == '}' || c == '[' || c == ']' || c == ',';
+        default:
+            return !UJSON_IS_SPACE(c);
+    }
 }
 
+  #if defined(UJSON_SSE2)
+
+/** Number of mask bits per byte returned by scanBlock() (log2) */
+#define UJSON_MASK_SHIFT            0
+
 /**
- * @brief Read until quote '"' found.
- * @param pJson JSON parsing structure
- * @param pStr String where read characters are stored
- * @param size Maximal size of the string
- * @return Last character, in case it is -1
+ * @brief Find the characters of a class in a block of UJSON_BLOCK_SIZE bytes.
+ * @param p Block
+ * @param cl Class
+ * @return Mask with one bit per byte
  */
-static int readString(PT_uJson pJson, char *pStr, int size)
+UJSON_INLINE unsigned long long scanBlock(const char *p, T_UJSON_Class cl)
 {
-    int c, c_last = -1, n = 0;
-    while (1)
-    {
-        c = getChar(pJson);
-        if (c < 0)
-            break;
+    __m128i b = _mm_loadu_si128((const __m128i*)p);
+    __m128i m;
 
-        if (c == '"' && c_last != '\\')
+    switch (cl)
+    {
+        case UJSON_CL_STRING:
+            m = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8('"')),
+                             _mm_cmpeq_epi8(b, _mm_set1_epi8('\\')));
             break;
-
-        if (c == '/' && c_last == '\\')
+        case UJSON_CL_DELIMITER:
         {
-            *(pStr - 1) = c;
+            // '[' and ']' differ from '{' and '}' only in bit 5
+            __m128i t = _mm_or_si128(b, _mm_set1_epi8(0x20));
+            m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(t, _mm_set1_epi8('{')),
+                                          _mm_cmpeq_epi8(t, _mm_set1_epi8('}'))),
+                             _mm_cmpeq_epi8(b, _mm_set1_epi8(',')));
+            break;
         }
-        else
+        default:
         {
-            n++;
-            if (n < size - 1)
-                *pStr++ = c;
+            // '\t', '\n', '\v', '\f' and '\r' are 9 to 13
+            __m128i t = _mm_sub_epi8(b, _mm_set1_epi8(9));
+            m = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')),
+                             _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t));
+            return ~_mm_movemask_epi8(m) & 0xFFFF;
         }
+    }
+    return _mm_movemask_epi8(m);
+}
 
-        c_last = c;
+  #elif defined(UJSON_NEON)
+
+/** Number of mask bits per byte returned by scanBlock() (log2) */
+#define UJSON_MASK_SHIFT            2
+
+/**
+ * @brief Find the characters of a class in a block of UJSON_BLOCK_SIZE bytes.
+ * @param p Block
+ * @param cl Class
+ * @return Mask with four bits per byte
+ */
+UJSON_INLINE unsigned long long scanBlock(const char *p, T_UJSON_Class cl)
+{
+    uint8x16_t b = vld1q_u8((const uint8_t*)p);
+    uint8x16_t m;
+
+    switch (cl)
+    {
+        case UJSON_CL_STRING:
+            m = vorrq_u8(vceqq_u8(b, vdupq_n_u8('"')), vceqq_u8(b, vdupq_n_u8('\\')));
+            break;
+        case UJSON_CL_DELIMITER:
+        {
+            // '[' and ']' differ from '{' and '}' only in bit 5
+            uint8x16_t t = vorrq_u8(b, vdupq_n_u8(0x20));
+            m = vorrq_u8(vorrq_u8(vceqq_u8(t, vdupq_n_u8('{')), vceqq_u8(t, vdupq_n_u8('}'))),
+                         vceqq_u8(b, vdupq_n_u8(',')));
+            break;
+        }
+        default:
+            // '\t', '\n', '\v', '\f' and '\r' are 9 to 13
+            m = vorrq_u8(vceqq_u8(b, vdupq_n_u8(' ')),
+                         vcleq_u8(vsubq_u8(b, vdupq_n_u8(9)), vdupq_n_u8(4)));
+            m = vmvnq_u8(m);
+            break;
     }
-    *pStr = '\0';
-    return c;
+
+    // narrow each byte of the comparison to four bits
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
 }
 
+  #endif
+
 /**
- * @brief Read until '{','}','[' or ']' is found.
- * @param pJson JSON parsing structure
- * @param pVal Value string where read characters are stored
- * @param size Maximal size of the value string
- * @param c_first Last read character
- * @return Last character, in case it is -1
+ * @brief Find the next character of a class.
+ * @param pBuf Buffer
+ * @param pos Position in the buffer
+ * @param len Length of the buffer
+ * @param cl Class
+ * @return Position of the character, -1 if not in the buffer
  */
-static int readValue(PT_uJson pJson, char *pVal, int size, int c_first)
+UJSON_INLINE long findClass(const char *pBuf, long pos, long len, T_UJSON_Class cl)
 {
-    int c;
-    int n = 0;
+    while (pos + UJSON_BLOCK_SIZE <= len)
+    {
+        unsigned long long mask = scanBlock(pBuf + pos, cl);
+        if (mask)
+            return pos + (__builtin_ctzll(mask) >> UJSON_MASK_SHIFT);
+        pos += UJSON_BLOCK_SIZE;
+    }
+
+    while (pos < len)
+    {
+        if (isClass(pBuf[pos], cl))
+            return pos;
+        pos++;
+    }
+    return -1;
+}
 
-    n++;
-    *pVal++ = c_first;
+/**
+ * @brief Skip white spaces.
+ * @param pBuf Buffer
+ * @param pos Position in the buffer
+ * @param len Length of the buffer
+ * @return Position of the next character which is not a white space
+ */
+static long skipSpaces(const char *pBuf, long pos, long len)
+{
+    // compact JSON has no white spaces
+    if (pos < len && !UJSON_IS_SPACE(pBuf[pos]))
+        return pos;
+    pos = findClass(pBuf, pos, len, UJSON_CL_TOKEN);
+    return pos < 0 ? len : pos;
+}
 
-    while (1)
+/**
+ * @brief Find the closing quote '"' of a string.
+ * @param pBuf Buffer
+ * @param pos Position after the opening quote
+ * @param len Length of the buffer
+ * @return Position of the closing quote, -1 if not in the buffer
+ */
+static long findStringEnd(const char *pBuf, long pos, long len)
+{
+    while ((pos = findClass(pBuf, pos, len, UJSON_CL_STRING)) >= 0)
     {
-        c = getChar(pJson);
-        if (c < 0)
+        if (pBuf[pos] == '"')
+            return pos;
+
+        // skip the escaped character
+        pos += 2;
+        if (pos > len)
             break;
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the end of a value which is not a string (number, true, ...).
+ * @param pBuf Buffer
+ * @param pos Position of the value
+ * @param len Length of the buffer
+ * @return Position of the character after the value, -1 if not in the buffer
+ */
+static long findValueEnd(const char *pBuf, long pos, long len)
+{
+    return findClass(pBuf, pos, len, UJSON_CL_DELIMITER);
+}
+
+#else
+
+/**
+ * @brief Skip white spaces.
+ * @param pBuf Buffer
+ * @param pos Position in the buffer
+ * @param len Length of the buffer
+ * @return Position of the next character which is not a white space
+ */
+static long skipSpaces(const char *pBuf, long pos, long len)
+{
+    while (pos < len && UJSON_IS_SPACE(pBuf[pos]))
+        pos++;
+    return pos;
+}
+
+/**
+ * @brief Find the closing quote '"' of a string.
+ * memchr() is vectorized by the C library (SSE2 on x86, NEON on ARM).
+ * @param pBuf Buffer
+ * @param pos Position after the opening quote
+ * @param len Length of the buffer
+ * @return Position of the closing quote, -1 if not in the buffer
+ */
+static long findStringEnd(const char *pBuf, long pos, long len)
+{
+    long start = pos;
+    const char *p;
 
+    while ((p = memchr(pBuf + pos, '"', len - pos)) != NULL)
+    {
+        long end = p - pBuf;
+        long n = 0;
+
+        // the quote is escaped if preceded by an odd number of backslashes
+        while (end - n > start && pBuf[end - n - 1] == '\\')
+            n++;
+        if ((n & 1) == 0)
+            return end;
+        pos = end + 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the end of a value which is not a string (number, true, ...).
+ * @param pBuf Buffer
+ * @param pos Position of the value
+ * @param len Length of the buffer
+ * @return Position of the character after the value, -1 if not in the buffer
+ */
+static long findValueEnd(const char *pBuf, long pos, long len)
+{
+    while (pos < len)
+    {
+        char c = pBuf[pos];
         if (c == '{' || c == '}' || c == '[' || c == ']' || c == ',')
+            return pos;
+        pos++;
+    }
+    return -1;
+}
+
+#endif
+
+/**
+ * @brief Read the 4 hexadecimal digits of an escape sequence "\uXXXX".
+ * @param pStr Digits
+ * @return Code unit, -1 if not 4 hexadecimal digits
+ */
+static long readHex4(const char *pStr)
+{
+    long code = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        char c = pStr[i];
+        code <<= 4;
+        if (c >= '0' && c <= '9')
+            code |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            code |= c - 'A' + 10;
+        else
+            return -1;
+    }
+    return code;
+}
+
+/**
+ * @brief Decode an escape sequence "\uXXXX" (or a surrogate pair) to UTF-8.
+ * @param pStr String
+ * @param i Position of the backslash
+ * @param len Length of the string
+ * @param pUtf8 Buffer receiving up to 4 bytes
+ * @param pCnt Number of bytes written to pUtf8
+ * @return Length of the escape sequence, 0 if not valid
+ */
+static long decodeUnicode(const char *pStr, long i, long len, char *pUtf8, int *pCnt)
+{
+    long code, low, seqLen = 6;
+
+    if (i + 6 > len || (code = readHex4(pStr + i + 2)) < 0)
+        return 0;
+
+    if (code >= 0xD800 && code <= 0xDBFF)
+    {
+        // combine a surrogate pair
+        if (i + 12 <= len && pStr[i + 6] == '\\' && pStr[i + 7] == 'u' &&
+            (low = readHex4(pStr + i + 8)) >= 0xDC00 && low <= 0xDFFF)
         {
-            ungetChar(pJson, c);
-            break;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            seqLen = 12;
+        }
+        else
+        {
+            code = 0xFFFD;
         }
+    }
+    else if (code >= 0xDC00 && code <= 0xDFFF)
+    {
+        code = 0xFFFD;
+    }
 
-        n++;
-        if (n < size - 1)
-            *pVal++ = c;
+    if (code < 0x80)
+    {
+        pUtf8[0] = (char)code;
+        *pCnt = 1;
     }
-    *pVal = '\0';
-    return c;
+    else if (code < 0x800)
+    {
+        pUtf8[0] = (char)(0xC0 | (code >> 6));
+        pUtf8[1] = (char)(0x80 | (code & 0x3F));
+        *pCnt = 2;
+    }
+    else if (code < 0x10000)
+    {
+        pUtf8[0] = (char)(0xE0 | (code >> 12));
+        pUtf8[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        pUtf8[2] = (char)(0x80 | (code & 0x3F));
+        *pCnt = 3;
+    }
+    else
+    {
+        pUtf8[0] = (char)(0xF0 | (code >> 18));
+        pUtf8[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        pUtf8[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        pUtf8[3] = (char)(0x80 | (code & 0x3F));
+        *pCnt = 4;
+    }
+    return seqLen;
 }
 
-/****************************************************************************/
+/**
+ * @brief Decode the escape sequences of a string in place.
+ * "\uXXXX" is decoded to UTF-8, unknown escape sequences are kept. The
+ * decoded string is never longer than the escaped one.
+ * @param pStr String
+ * @param i Offset of the first backslash
+ * @param len Length of the string
+ * @return New length of the string
+ */
+UJSON_NOINLINE long decodeEscapes(char *pStr, long i, long len)
+{
+    long n = i;
+
+    while (i < len)
+    {
+        char c = pStr[i];
+        if (c == '\\' && i + 1 < len)
+        {
+            char utf8[4];
+            long seqLen;
+            int cnt;
+
+            switch (pStr[i + 1])
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    c = pStr[i + 1];
+                    break;
+                case 'b':
+                    c = '\b';
+                    break;
+                case 'f':
+                    c = '\f';
+                    break;
+                case 'n':
+                    c = '\n';
+                    break;
+                case 'r':
+                    c = '\r';
+                    break;
+                case 't':
+                    c = '\t';
+                    break;
+                case 'u':
+                    seqLen = decodeUnicode(pStr, i, len, utf8, &cnt);
+                    if (seqLen)
+                    {
+                        memcpy(pStr + n, utf8, cnt);
+                        n += cnt;
+                        i += seqLen;
+                        continue;
+                    }
+                    // no break
+                default:
+                    // keep an unknown escape sequence
+                    pStr[n++] = c;
+                    pStr[n++] = pStr[i + 1];
+                    i += 2;
+                    continue;
+            }
+            pStr[n++] = c;
+            i += 2;
+            continue;
+        }
+        pStr[n++] = c;
+        i++;
+    }
+    return n;
+}
 
 /**
+ * @brief Terminate a string in place.
+ * Escape sequences are decoded, "\uXXXX" to UTF-8. The decoded string is
+ * never longer than the escaped one. Unknown escape sequences are kept.
+ * @param pStr String
+ * @param len Length of the string, the character at pStr[len] is overwritten
+ * @return New length of the string
  */
-void UJSON_init(PT_uJson pJson)
+UJSON_INLINE int terminateString(char *pStr, long len)
 {
-    if (pJson)
+    char *pEsc = memchr(pStr, '\\', len);
+
+    if (pEsc)
+        len = decodeEscapes(pStr, pEsc - pStr, len);
+    pStr[len] = '\0';
+    return (int)len;
+}
+
+/**
+ * @brief Copy a string into a buffer of the parsing structure.
+ * @param pDst Buffer
+ * @param size Size of the buffer
+ * @param pSrc String
+ * @param len Length of the string
+ * @return Length of the copied string
+ */
+static int copyString(char *pDst, int size, const char *pSrc, int len)
+{
+    if (len > size - 1)
+        len = size - 1;
+    memcpy(pDst, pSrc, len);
+    pDst[len] = '\0';
+    return len;
+}
+
+/**
+ * @brief Pass a pair to the callback function startPair().
+ * @param pJson JSON parsing structure
+ * @param pPair Pair ('\0' terminated)
+ * @param len Length of the pair
+ * @param copy Set if the pair is copied into pJson->pPair
+ */
+static void emitPair(PT_uJson pJson, char *pPair, int len, int copy)
+{
+    if (copy)
     {
-        memset(pJson, 0, sizeof(T_uJson));
-        pJson->unget_c = -1;
-        pJson->maxReadCnt = -1;
+        pJson->pairLen = copyString(pJson->pPair, pJson->pairSize, pPair, len);
+        pPair = pJson->pPair;
     }
+    else
+    {
+        pJson->pairLen = len;
+    }
+    if (pJson->startPair)
+        pJson->startPair(pJson, pPair);
 }
 
 /**
+ * @brief Pass a value to the callback function value().
+ * @param pJson JSON parsing structure
+ * @param pPair Pair ('\0' terminated), NULL for a value inside an array
+ * @param pValue Value ('\0' terminated)
+ * @param len Length of the value
+ * @param copy Set if the value is copied into pJson->pValue
  */
-int UJSON_parse(PT_uJson pJson)
+static void emitValue(PT_uJson pJson, char *pPair, char *pValue, int len, int copy)
 {
-    int c;
-    T_UJSON_State state = UJSON_ST_NONE;
+    if (copy)
+    {
+        // like the pair, the value is kept in the buffer of the parsing structure
+        pJson->valueLen = copyString(pJson->pValue, pJson->valueSize, pValue, len);
+        pPair = pJson->pPair;
+        pValue = pJson->pValue;
+    }
+    else
+    {
+        pJson->valueLen = len;
+        if (!pPair)
+        {
+            pPair = "";
+            pJson->pairLen = 0;
+        }
+    }
+    if (pJson->value)
+        pJson->value(pJson, pPair, pValue);
+}
 
-    if (!pJson || !pJson->getChar || !pJson->pPair || !pJson->pValue)
+/**
+ * @brief Pass a value which is not a string to the callback function value().
+ * Trailing white spaces are removed.
+ * @param pJson JSON parsing structure
+ * @param pPair Pair ('\0' terminated), NULL for a value inside an array
+ * @param pBuf Buffer
+ * @param pos Position of the value
+ * @param end Position after the value
+ * @param len Length of the buffer
+ * @param copy Set if the value is copied into pJson->pValue
+ */
+static void emitScalar(PT_uJson pJson, char *pPair, char *pBuf, long pos, long end, long len, int copy)
+{
+    long n = end;
+
+    while (n > pos && UJSON_IS_SPACE(pBuf[n - 1]))
+        n--;
+
+    if (n < end)
+    {
+        // overwrite a white space
+        pBuf[n] = '\0';
+        emitValue(pJson, pPair, pBuf + pos, (int)(n - pos), copy);
+    }
+    else if (end < len)
+    {
+        // overwrite the delimiter for the time of the callback
+        char c = pBuf[end];
+        pBuf[end] = '\0';
+        emitValue(pJson, pPair, pBuf + pos, (int)(n - pos), copy);
+        pBuf[end] = c;
+    }
+    else
+    {
+        // value at the very end of the data
+        char scalar[UJSON_SCALAR_SIZE];
+        emitValue(pJson, pPair, scalar, copyString(scalar, UJSON_SCALAR_SIZE, pBuf + pos, (int)(n - pos)), copy);
+    }
+}
+
+/**
+ * @brief Parse a pair and its value.
+ * Nothing is passed to the callback functions until the value is complete.
+ * @param pJson JSON parsing structure
+ * @param pBuf Buffer
+ * @param pos Position of the opening quote of the pair
+ * @param len Length of the buffer
+ * @param last Set if no more data follows
+ * @param copy Set if pairs and values are copied
+ * @return Position after the value, 0 if not complete, -1 on a syntax error
+ */
+static long parsePair(PT_uJson pJson, char *pBuf, long pos, long len, int last, int copy)
+{
+    char *pPair = pBuf + pos + 1;
+    long pairEnd, end, p;
+    int pairLen;
+
+    pairEnd = findStringEnd(pBuf, pos + 1, len);
+    if (pairEnd < 0)
+        return 0;
+    p = skipSpaces(pBuf, pairEnd + 1, len);
+    if (p == len)
+        return 0;
+    if (pBuf[p] != ':')
         return -1;
+    p = skipSpaces(pBuf, p + 1, len);
+    if (p == len)
+        return 0;
 
-    while (1)
+    pJson->expectPair = 0;
+    switch (pBuf[p])
     {
-        // read next character
-        c = getChar(pJson);
-        if (c < 0)
-            break;
+        // object or array, the value is parsed afterwards
+        case '{':
+        case '[':
+            pairLen = terminateString(pPair, pairEnd - pos - 1);
+            emitPair(pJson, pPair, pairLen, copy);
+            return p;
+
+        // string
+        case '"':
+            end = findStringEnd(pBuf, p + 1, len);
+            if (end < 0)
+                break;
+            pairLen = terminateString(pPair, pairEnd - pos - 1);
+            emitPair(pJson, pPair, pairLen, copy);
+            emitValue(pJson, pPair, pBuf + p + 1, terminateString(pBuf + p + 1, end - p - 1), copy);
+            return end + 1;
+
+        // number, true, false or null
+        default:
+            end = findValueEnd(pBuf, p, len);
+            if (end < 0)
+            {
+                if (!last)
+                    break;
+                end = len;
+            }
+            pairLen = terminateString(pPair, pairEnd - pos - 1);
+            emitPair(pJson, pPair, pairLen, copy);
+            emitScalar(pJson, pPair, pBuf, p, end, len, copy);
+            return end;
+    }
 
-        // skip spaces
-        if (isspace(c))
-            continue;
+    // value not complete
+    pJson->expectPair = 1;
+    return 0;
+}
 
+/**
+ * @brief Parse JSON data in a buffer.
+ * @param pJson JSON parsing structure
+ * @param pBuf Buffer
+ * @param len Length of the data in the buffer
+ * @param last Set if no more data follows
+ * @param copy Set if pairs and values are copied into pJson->pPair and pJson->pValue
+ * @return Number of bytes consumed, -1 on a syntax error
+ */
+static long parse(PT_uJson pJson, char *pBuf, long len, int last, int copy)
+{
+    long pos = 0, p, end;
+    int c;
+
+    while (!pJson->eof)
+    {
+        p = skipSpaces(pBuf, pos, len);
+        if (p == len)
+            return len;
+
+        c = pBuf[p];
         switch (c)
         {
-            // start of object
+            // start of object or array
             case '{':
-                state = UJSON_ST_NONE;
-                pJson->objectDepth++;
-                if (pJson->startObject)
-                    pJson->startObject(pJson);
+            case '[':
+                if (pJson->depth == UJSON_DEPTH_MAX)
+                    return -1;
+                if (c == '[')
+                    pJson->nesting |= 1UL << pJson->depth;
+                else
+                    pJson->nesting &= ~(1UL << pJson->depth);
+                pJson->depth++;
+                if (c == '{')
+                {
+                    pJson->expectPair = 1;
+                    pJson->objectDepth++;
+                    if (pJson->startObject)
+                        pJson->startObject(pJson);
+                }
+                else
+                {
+                    pJson->expectPair = 0;
+                    if (pJson->startArray)
+                        pJson->startArray(pJson);
+                }
+                end = p + 1;
                 break;
 
-            // end of object
+            // end of object or array
             case '}':
-                pJson->objectDepth--;
-                if (pJson->endObject)
-                    pJson->endObject(pJson);
-                break;
-
-            // start of array
-            case '[':
-                state = UJSON_ST_ARRAY;
-                if (pJson->startArray)
-                    pJson->startArray(pJson);
+            case ']':
+                if (pJson->depth > 0)
+                    pJson->depth--;
+                pJson->expectPair = 0;
+                if (c == '}')
+                {
+                    pJson->objectDepth--;
+                    if (pJson->endObject)
+                        pJson->endObject(pJson);
+                }
+                else
+                {
+                    if (pJson->endArray)
+                        pJson->endArray(pJson);
+                }
+                end = p + 1;
                 break;
 
-            // end of array
-            case ']':
-                if (pJson->endArray)
-                    pJson->endArray(pJson);
-                state = UJSON_ST_NONE;
+            // next pair or value coming
+            case ',':
+                pJson->expectPair = pJson->depth > 0 && !(pJson->nesting & (1UL << (pJson->depth - 1)));
+                end = p + 1;
                 break;
 
             // start of a pair or value
             case '"':
-                if (state == UJSON_ST_NONE)
+                if (pJson->expectPair)
                 {
-                    // start of pair
-                    c = readString(pJson, pJson->pPair, pJson->pairSize);
-                    if (pJson->startPair)
-                        pJson->startPair(pJson, pJson->pPair);
+                    end = parsePair(pJson, pBuf, p, len, last, copy);
                 }
-                else if (state == UJSON_ST_VALUE || state == UJSON_ST_ARRAY)
+                else
                 {
-                    // start of value
-                    c = readString(pJson, pJson->pValue, pJson->valueSize);
-                    if (pJson->value)
-                        pJson->value(pJson, pJson->pPair, pJson->pValue);
-                    // if we are in an array there may be more values coming
-                    if (state != UJSON_ST_ARRAY)
-                        state = UJSON_ST_NONE;
+                    end = findStringEnd(pBuf, p + 1, len);
+                    if (end < 0)
+                        return pos;
+                    emitValue(pJson, NULL, pBuf + p + 1, terminateString(pBuf + p + 1, end - p - 1), copy);
+                    end++;
                 }
                 break;
 
-            // value coming
-            case ':':
-                state = UJSON_ST_VALUE;
-                break;
-
-            // next value inside an array coming
-            case ',':
-                if (state != UJSON_ST_ARRAY)
-                    state = UJSON_ST_NONE;
-                break;
-
+            // value without a pair
             default:
-                if (state == UJSON_ST_VALUE || state == UJSON_ST_ARRAY)
+                end = findValueEnd(pBuf, p, len);
+                if (end < 0)
                 {
-                    c = readValue(pJson, pJson->pValue, pJson->valueSize, c);
-                    if (pJson->value)
-                        pJson->value(pJson, pJson->pPair, pJson->pValue);
+                    if (!last)
+                        return pos;
+                    end = len;
                 }
+                emitScalar(pJson, NULL, pBuf, p, end, len, copy);
                 break;
         }
 
-        if (c < 0)
+        if (end <= 0)
+            return end < 0 ? -1 : pos;
+        pos = end;
+    }
+
+    return pos;
+}
+
+/****************************************************************************/
+
+/**
+ */
+void UJSON_init(PT_uJson pJson)
+{
+    if (pJson)
+    {
+        memset(pJson, 0, sizeof(T_uJson));
+        pJson->unget_c = -1;
+        pJson->maxReadCnt = -1;
+    }
+}
+
+/**
+ */
+int UJSON_parse(PT_uJson pJson)
+{
+    char buf[UJSON_BUFFER_SIZE];
+    long len = 0, n;
+    int last = 0, c;
+
+    if (!pJson || !pJson->getChar || !pJson->pPair || !pJson->pValue)
+        return -1;
+
+    while (!pJson->eof)
+    {
+        // fill the buffer
+        while (!last && len < UJSON_BUFFER_SIZE)
+        {
+            c = getChar(pJson);
+            if (c < 0)
+                last = 1;
+            else
+                buf[len++] = (char)c;
+        }
+
+        n = parse(pJson, buf, len, last, 1);
+        if (n < 0)
+            return -1;
+        if (last)
             break;
+
+        // a pair and its value must fit into the buffer
+        if (n == 0)
+            return -1;
+
+        // keep the data not consumed
+        len -= n;
+        memmove(buf, buf + n, len);
     }
 
+    pJson->eof = 1;
     return 0;
 }
+
+/**
+ */
+long UJSON_parseBuffer(PT_uJson pJson, char *pBuf, long len, int last)
+{
+    if (!pJson || !pBuf || len < 0)
+        return -1;
+    return parse(pJson, pBuf, len, last, 0);
+}
@@ -39,6 +39,23 @@
  *
  * Parses generic JSON data and calls different user-defined callback functions.
  *
+ * The parser has two modes:
+ *   - UJSON_parse() pulls the data character by character through the
+ *     callback UJSON_GetChar and copies pairs and values into the buffers
+ *     pPair and pValue.
+ *   - UJSON_parseBuffer() tokenizes a buffer in place. Pairs and values are
+ *     handed to the callbacks as slices of the buffer (pointer and length in
+ *     pairLen / valueLen), terminated with '\0' in place. Nothing is copied
+ *     and all the parsing state is kept in T_uJson, so several buffers can be
+ *     parsed at the same time. The buffer may be passed in parts.
+ *
+ * The end of a string is found with memchr(), which the C library vectorizes
+ * (SSE2 on x86, NEON on ARM), white spaces and values are scanned byte by
+ * byte. Set UJSON_SIMD_EN to 1 to scan them all in blocks of 16 bytes with
+ * SSE2 or NEON instructions (-mfpu=neon on 32-bit ARM). Both give the same
+ * result, but the tokens of json.cgi requests are short and the blocks were
+ * slower on x86: measure with examples/OSC-json-check before enabling them.
+ *
  * Callback functions:
  *   - \b UJSON_GetChar     Called to get the next character from a stream (file or buffer)
  *   - \b UJSON_startObject Called when a new object was found ("{")
@@ -52,6 +69,14 @@
  * @{
  */
  
+/** Size of the buffer used by UJSON_parse() */
+#define UJSON_BUFFER_SIZE           1024
+
+/** Scan the data in blocks with SSE2 or NEON instructions if available (0/1) */
+#ifndef UJSON_SIMD_EN
+  #define UJSON_SIMD_EN             0
+#endif
+
 /** Callback function type to get the next character */
 typedef int  (*UJSON_GetChar)(void* pJson);
 /** Callback function type when an object is starting, i.e. '{' was detected */
@@ -89,6 +114,11 @@ typedef struct t_uJson
     UJSON_value value;              /**< callback function when a pair/value was detected */
     UJSON_startArray startArray;    /**< callback function when an array is starting */
     UJSON_endArray endArray;        /**< callback function when an array is ending */
+    int   pairLen;                  /**< length of the pair passed to the callbacks */
+    int   valueLen;                 /**< length of the value passed to the callbacks */
+    int   depth;                    /**< nesting depth of objects and arrays */
+    unsigned long nesting;          /**< one bit per nesting level, set for an array */
+    int   expectPair;               /**< set if the next string is a pair */
 } T_uJson, *PT_uJson;
 
 /**
@@ -99,11 +129,33 @@ void UJSON_init(PT_uJson pJson);
 
 /**
  * @brief Start the JSON parser.
+ * The data is read through the callback getChar and parsed with
+ * UJSON_parseBuffer() in blocks of UJSON_BUFFER_SIZE bytes. A pair and its
+ * value must fit in one block. Pairs and values are copied into pPair and
+ * pValue, truncated to pairSize and valueSize.
  * @param pJson Parsing structure
- * @return 0 on success
+ * @return 0 on success, -1 on error
  */
 int UJSON_parse(PT_uJson pJson);
 
+/**
+ * @brief Parse JSON data in a buffer without copying it.
+ * Pairs and values are terminated with '\0' in the buffer and passed to the
+ * callbacks. They are only valid until the callback returns. Escape
+ * sequences are decoded, "\uXXXX" to UTF-8.
+ *
+ * The function returns before a pair or value which is not complete in the
+ * buffer. The caller may then append more data to the bytes not consumed and
+ * call the function again with the same parsing structure. The parsing stops
+ * when a callback sets eof.
+ * @param pJson Parsing structure initialized with UJSON_init()
+ * @param pBuf Buffer, modified by the parser
+ * @param len Length of the data in the buffer
+ * @param last Set if no more data follows
+ * @return Number of bytes consumed, -1 on a syntax error
+ */
+long UJSON_parseBuffer(PT_uJson pJson, char *pBuf, long len, int last);
+
 /** @} JSONPARSER */
 
 /** @} UTILITIES */
@@ -24,6 +24,7 @@
   #include <windows.h>
 #elif defined(LINUX)
   #include <sys/time.h>
+  #include <time.h>
   #include <unistd.h>
 #endif
 
@@ -40,6 +41,23 @@ void SYS_sleep(unsigned long ms)
   #endif
 }
 
+/**
+ */
+unsigned long long SYS_getMicroseconds(void)
+{
+  #if defined(WIN32)
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long long)(count.QuadPart / frequency.QuadPart) * 1000000ULL +
+           (unsigned long long)(count.QuadPart % frequency.QuadPart) * 1000000ULL / frequency.QuadPart;
+  #elif defined(LINUX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+  #endif
+}
+
 /**
  */
 size_t freadln(char *buffer, size_t max, FILE *fp, int* pEOF)
@@ -176,3 +194,24 @@ void str_replaceChar(char* pStr, char c1, char c2)
         pStr++;
     }
 }
+
+/**
+ */
+unsigned int str_hash(const void *pData, size_t len)
+{
+    return str_hashAppend(2166136261u, pData, len);
+}
+
+/**
+ */
+unsigned int str_hashAppend(unsigned int hash, const void *pData, size_t len)
+{
+    const unsigned char *p = (const unsigned char*)pData;
+
+    while (len--)
+    {
+        hash ^= *p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
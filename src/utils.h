@@ -47,6 +47,13 @@
  */
 void SYS_sleep(unsigned long ms);
 
+/**
+ * @brief Get a monotonic time stamp.
+ * The time stamp is only meaningful relative to another one.
+ * @return Time in microseconds
+ */
+unsigned long long SYS_getMicroseconds(void);
+
 /**
  * @brief Read one line of a file and put it in a buffer. Support only ANSI file.
  * @param buffer Buffer where line will be stored.
@@ -84,6 +91,23 @@ char *str_trimLeadingTrailingSpaces(char *pStr);
  */
 void str_replaceChar(char* pStr, char c1, char c2);
 
+/**
+ * @brief Compute a 32-bit FNV-1a hash of a memory block.
+ * @param pData Memory block
+ * @param len Length of the memory block
+ * @return Hash value
+ */
+unsigned int str_hash(const void *pData, size_t len);
+
+/**
+ * @brief Continue a 32-bit FNV-1a hash with another memory block.
+ * @param hash Hash of the previous memory blocks (see str_hash())
+ * @param pData Memory block
+ * @param len Length of the memory block
+ * @return Hash value
+ */
+unsigned int str_hashAppend(unsigned int hash, const void *pData, size_t len);
+
 /** @} UTILITIES */
 
 #endif // _UTILS_H_
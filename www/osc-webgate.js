@@ -14,6 +14,10 @@ var polling_enabled = false;
 var polling_time = 0;
 var tags = undefined;
 var version = "1.0"
+var session = undefined;
+var seq = undefined;
+var writing = {};
+var pending = {};
 
 //
 // Create a tag object.
@@ -77,6 +81,9 @@ function setBusy(id, busy) {
         if (tags[i].id === id)
             tags[i].busy = busy;
     }  
+    // changes skipped while busy are fetched with the next full poll
+    if (busy === false)
+        seq = undefined;
 }
 
 //
@@ -91,7 +98,7 @@ function createVariableList(unique) {
         {
             for (j = 0; j < list.length; j++)
             {
-                if (tags[i].variable === list[j])
+                if (tags[i].variable === list[j].var)
                 {
                     add = false;
                     break;
@@ -134,14 +141,34 @@ function updateElement(tag, value)
     }
 }
 
+//
+// Update all HTML elements linked to a variable
+//
+function updateVariable(variable, value)
+{
+    for (i = 0; i < tags.length; i++)
+    {
+        if (tags[i].variable === variable)
+            updateElement(tags[i], value);
+    }
+}
+
 //
 // Self-executing function to poll variables from OSC-webgate.
+// The variable list is subscribed once, later polls send the session id
+// and only receive the variables changed since the last poll.
 //
 (function poll() {
     setTimeout(function() {
         if (polling_enabled === true)
         {
-            var sendData = {"version" : "1", "read" : createVariableList(false)};
+            var sendData;
+            if (session === undefined)
+                sendData = {"version" : "1", "subscribe" : createVariableList(true)};
+            else if (seq === undefined)
+                sendData = {"version" : "1", "session" : session};
+            else
+                sendData = {"version" : "1", "session" : session, "since" : seq};
             $.ajax({
                 url: "/cgi-bin/json.cgi",
                 type: "POST",
@@ -150,11 +177,18 @@ function updateElement(tag, value)
                 complete: poll,
                 timeout: 2000,
                 success: function(data) {
+                    if ("session" in data) {
+                        session = data.session;
+                        seq = data.seq;
+                    }
+                    else {
+                        // session unknown or expired, subscribe again
+                        session = undefined;
+                        seq = undefined;
+                    }
                     if ("read" in data) {
-                        if (data.read.length === sendData.read.length) {
-                            for (i = 0; i < data.read.length; i++)
-                                updateElement(tags[i], data.read[i].val);
-                        }
+                        for (j = 0; j < data.read.length; j++)
+                            updateVariable(data.read[j].var, data.read[j].val);
                     }
                 }
             })
@@ -162,6 +196,47 @@ function updateElement(tag, value)
     }, polling_time);
 })();
 
+//
+// Send a value of a variable to the OSC-webgate server.
+// Only one write per variable is sent at once, values set meanwhile are
+// coalesced and only the last one is sent. A throttled write ("429 Too Many
+// Requests") is sent again after the time given by the server.
+//
+function sendValue(variable, value) {
+    if (writing[variable] === true) {
+        pending[variable] = value;
+        return;
+    }
+    writing[variable] = true;
+
+    var sendData = {"version" : "1", "write" : [ {"var" : variable, "val" : value} ] };
+    $.ajax({
+        url: "/cgi-bin/json.cgi",
+        type: "POST",
+        dataType: "json",
+        data : JSON.stringify(sendData),
+        timeout: 2000,
+        complete: function(xhr) {
+            var wait = 0;
+            if (xhr.status === 429) {
+                wait = 1000 * (parseInt(xhr.getResponseHeader("Retry-After")) || 1);
+                if (!(variable in pending))
+                    pending[variable] = value;
+            }
+            if (!(variable in pending)) {
+                writing[variable] = false;
+                return;
+            }
+            setTimeout(function() {
+                var next = pending[variable];
+                delete pending[variable];
+                writing[variable] = false;
+                sendValue(variable, next);
+            }, wait);
+        }
+    })
+}
+
 //
 // Write a value to the OSC-webgate server.
 //
@@ -174,30 +249,24 @@ function writeValue(id) {
             if (obj === null)
                 return;
 
-            var sendData = {"version" : "1", "write" : [ {"var" : tags[i].variable, "val" : ""} ] };
+            var value = "";
             
             if ("type" in obj) {
                 if (obj.type === "text") {
-                    sendData.write[0].val = obj.value;
+                    value = obj.value;
                 }
                 else if (obj.type === "checkbox") {
-                    sendData.write[0].val = (obj.checked === false) ? "0" : "1";
+                    value = (obj.checked === false) ? "0" : "1";
                 }
                 else if (obj.type === "range") {
-                    sendData.write[0].val = obj.value;
+                    value = obj.value;
                 }
             }
             else {
-                sendData.write[0].val = obj.innerText;
+                value = obj.innerText;
             }
      
-            $.ajax({
-                url: "/cgi-bin/json.cgi",
-                type: "POST",
-                dataType: "json",
-                data : JSON.stringify(sendData),
-                timeout: 2000,
-            })
+            sendValue(tags[i].variable, value);
         }
     }
 }